@@ -0,0 +1,25 @@
+#ifndef ANPR_HPP
+#define ANPR_HPP
+
+/* Everything libanpr exposes, in the order the headers expect each other */
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "debug_images.hpp"
+#include "detection_context.hpp"
+#include "frame_source.hpp"
+#include "known_cars.hpp"
+#include "metrics.hpp"
+#include "ocr_pool.hpp"
+#include "pipeline.hpp"
+#include "tracker.hpp"
+#include "motion_gate.hpp"
+#include "event_writer.hpp"
+#include "plate_log.hpp"
+#include "latency_budget.hpp"
+#include "multi_stream.hpp"
+#include "image_batch.hpp"
+#include "shm_ring.hpp"
+#include "engine.hpp"
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef DEBUG_IMAGES_HPP
+#define DEBUG_IMAGES_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class DebugFormat {
+	JPEG,		// Smallest files, the slowest to encode
+	PNG,		// Lossless with compression level 1
+	RAW		// Binary PGM or PPM, a header and the pixels as they are
+};
+
+struct DebugConfig {
+	std::string directory = "debug";
+	DebugFormat format = DebugFormat::JPEG;
+	std::vector<std::string> stages;	// Names of the images to save, for example "crop" or "sobel", empty for all
+	int every = 1;				// Only every n:th frame is saved
+	bool misreads = false;			// Only frames where no plate could be read
+	size_t queue_size = 8;			// Frames waiting for the writer, frames beyond this are dropped
+};
+
+/** Beskrivning:  Bilderna från en bildruta på väg till DebugImages. Stegen lämnar sina bilder med add(), som kopierar dem till en buffert
+*									som återanvänds från tidigare bildrutor, så att det enda steget betalar är kopieringen. OCR trådarna kan lägga till
+*									bilder i samma bildruta samtidigt
+* Return:       DebugFrame - DebugFrame objekt, skapas av DebugImages::begin()
+* Exempel:
+*               frame->add("sobel", ctx.gradX) => bilden sparas när bildrutan är klar, ifall steget sobel är valt
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class DebugFrame {
+	friend class DebugImages;
+	const DebugConfig &config;
+	std::mutex mutex;
+	std::deque<std::pair<std::string, cv::Mat>> images;	// The first used hold this frame's images, the rest are buffers kept for reuse
+	size_t used = 0;
+	long number = 0;		// Frame number in the stream, the same as in --output and --plate-log
+	std::string stream;		// Name of the stream in multi-camera mode, empty otherwise
+
+	DebugFrame(const DebugConfig &config) : config(config) {}
+	cv::Mat& slot(const char *name);
+public:
+	bool wants(const char *name) const;
+	void add(const char *name, const cv::Mat &img);
+};
+
+/** Beskrivning:  Sparar mellanresultat från alla steg som bilder i en katalog, motsvarar flaggan --debug. Kodningen och skrivningen görs av en
+*									egen tråd så att bildrutorna bara betalar för att kopiera bilderna. Kön är begränsad och när skrivaren inte
+*									hinner med kastas hela bildrutor istället för att vänta. Vilka bildrutor och steg som sparas styrs av DebugConfig.
+*									Varje Engine har en egen, så att flera motorer i samma process kan spara till olika kataloger
+* Argument 1:   DebugConfig - katalog, format, steg och urval av bildrutor
+* Return:       DebugImages - DebugImages objekt
+* Exempel:
+*               DebugImages debug(config)
+*               DebugFrame *frame = debug.begin(120, "entrance") => NULL ifall bildrutan inte ska sparas
+*               debug.end(frame, image, matches, candidates) => "debug/entrance-120-0-crop.jpg", "debug/entrance-120-1-done.jpg", ...
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class DebugImages {
+	DebugConfig config;
+	std::vector<std::unique_ptr<DebugFrame>> frames;	// Every frame ever made, they are reused once written or discarded
+	std::vector<DebugFrame*> spare;
+	std::deque<DebugFrame*> queue;
+	std::mutex mutex;
+	std::condition_variable has_work;
+	std::thread writer;
+	bool stopping = false;
+	std::vector<int> params;
+	const char *extension;
+	std::atomic<long> frames_seen{0};
+	long frames_written = 0;
+	long frames_dropped = 0;
+	long images_written = 0;
+
+	void recycle(DebugFrame *frame);
+	void write();
+public:
+	DebugImages(DebugConfig config);
+	~DebugImages();
+	DebugFrame* begin(long number, const std::string &stream = "");
+	void end(DebugFrame *frame, const cv::Mat &image, const std::vector<Match> &matches, const std::vector<std::vector<cv::Point>> &candidates);
+	void discard(DebugFrame *frame);
+	void report(std::ostream &out);
+};
+
+#endif
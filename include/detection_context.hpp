@@ -0,0 +1,76 @@
+#ifndef DETECTION_CONTEXT_HPP
+#define DETECTION_CONTEXT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#define PROCESSING_WIDTH 512	// Default length of the long side of the frame while locating candidates
+#define KEEP 5			// Default limit of the number of license plates
+
+/* One horizontal band of locate_front_end() and its buffers, kept between frames. The buffers hold the band's rows and the halo each step needs */
+struct FrontEndBand {
+	int first = 0;				// First row of the frame the band writes
+	int last = 0;				// One past its last row
+	std::vector<uint8_t> eroded;
+	std::vector<uint8_t> opened;
+	std::vector<uint8_t> dilated;
+	std::vector<uint8_t> blackhat;
+	std::vector<uint8_t> normalized;
+	std::vector<uint8_t> blur;
+	std::vector<uint16_t> sums;		// One row of the vertical pass of the blur
+	std::vector<uint8_t> padded;		// One row of the horizontal min or max, with the kernel's margin
+	std::vector<uint8_t> prefix;		// Running min or max down each block of rows
+	std::vector<uint8_t> suffix;		// Running min or max up each block of rows
+	std::vector<uint8_t> border;		// Neutral row for rows outside the image
+	uint16_t max_gradient = 0;
+	uint32_t histogram[256];		// Of the closed gradient, for Otsu
+};
+
+/** Beskrivning:  Arbetsyta för locateCandidates(), äger alla bilder, strukturelement och konturer som behövs för att hitta kandidater.
+*									Bilderna skapas vid första bildrutan och återanvänds sedan, så att en ström med samma upplösning inte allokerar
+*									något eget minne per bildruta. En kontext per ström och tråd, den får inte delas mellan trådar.
+*									processing_width och keep kan ändras mellan bildrutor, till exempel av LatencyBudget
+* Return:       DetectionContext - DetectionContext objekt
+* Exempel:
+*               DetectionContext detection;
+*               locateCandidates(frame, detection) => referens till detection.candidates
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class DetectionContext {
+public:
+	int processing_width = PROCESSING_WIDTH;	// Long side of the frame after resizing, the aspect ratio is kept
+	int keep = KEEP;				// Number of the highest ranked contours kept as candidates
+	double scale = 1;				// Processing pixels per frame pixel, set by setFrameSize()
+	double area_scale = 1;				// Pixels of the frame squashed to 512x512 per processing pixel, RECT_DIFF is in these
+	int bands = 0;					// Bands locate_front_end() runs in parallel, 0 picks from the threads and the height
+	DebugFrame *debug = NULL;			// Debug images of the current frame, NULL when it is not saved
+
+	/* Structuring elements, built once */
+	cv::Mat largerKernel;		// 4x4, removes islands
+	cv::Mat rectangleKernel;	// 13x5, blackhat and closing of the gradient
+	cv::Mat squareKernel;		// 3x3, closing before the white regions
+
+	/* Images between the stages, all in the processing size */
+	cv::Mat resizedFrame;		// Before grayscale conversion
+	cv::Mat processedFrame;		// Grayscale
+	cv::Mat morphFrame;		// Intermediate result of open, close and blackhat
+	cv::Mat blackhatFrame;
+	cv::Mat lightFrame;
+	cv::Mat gradMagnitude;		// 16 bit Sobel gradient before normalisation
+	cv::Mat gradX;			// Normalised gradient and later the binary image
+	cv::Mat blurFrame;
+	std::vector<FrontEndBand> front_end;	// Buffers of locate_front_end(), one per band
+
+	/* Contours, the inner vectors keep their capacity between frames */
+	std::vector<std::vector<cv::Point>> contours;
+	std::vector<double> scores;		// Ranking of each contour, only set for those that passed the shape filters
+	std::vector<size_t> order;		// Contours that passed the shape filters, the best ctx.keep first
+	std::vector<std::vector<cv::Point>> candidates;
+
+	DetectionContext();
+	void setFrameSize(cv::Size frame);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct EngineConfig {
+	OcrPoolConfig ocr;
+	std::string known_cars;		// List of parked cars, empty for none
+	int reload_interval = 1000;	// How often the list is checked for changes, 0 to never reload it
+	bool track = false;		// Follow candidates between frames and vote over their reads
+	TrackerConfig tracker;
+	bool motion = false;		// Skip frames and regions where nothing changed
+	MotionGateConfig motion_config;
+	bool budget = false;		// Adapt width, candidates and frame stride to a deadline per frame
+	LatencyBudgetConfig budget_config;
+	int processing_width = PROCESSING_WIDTH;
+	int bands = 0;			// Parallel bands of the detection front-end, 0 picks from the threads
+	bool debug = false;		// Save the images of every stage in the background
+	DebugConfig debug_config;
+};
+
+/** Beskrivning:  En instans av hela anpr algoritmen som äger allt den behöver: konfiguration, Tesseract motorer, lista över godkänt parkerade bilar,
+*									spårning, förändringsdetektering, tidsbudget och arbetsytor. Inget tillstånd delas mellan instanser, så flera Engine
+*									kan köras samtidigt i samma process på var sin tråd. En instans ska bara anroppas från en tråd åt gången
+* Argument 1:   EngineConfig - konfiguration för instansen
+* Return:       Engine - Engine objekt
+* Exempel:
+*               Engine engine(config)
+*               engine.ok() => false ifall Tesseract eller ocr modellen inte kunde initieras
+*               engine.process(frame) => bildrutans matchningar, engine.candidates() är kandidaterna de kom från
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class Engine {
+	EngineConfig config;
+	DebugImages *debug = NULL;
+	OcrPool *ocr;
+	KnownCars *known_cars;
+	PlateTracker *tracker = NULL;
+	MotionGate *gate = NULL;
+	LatencyBudget *budget = NULL;
+	DetectionContext detection;
+	const std::vector<std::vector<cv::Point>> *shown;	// Candidates of the last frame, in detection or held by the gate
+	long frames = 0;			// Calls to process(), the frame number when none is given
+public:
+	Engine(EngineConfig config);
+	~Engine();
+	Engine(const Engine&) = delete;
+	Engine& operator=(const Engine&) = delete;
+	bool ok() const;
+	std::vector<Match> process(const cv::Mat &frame, long number = -1);
+	const std::vector<std::vector<cv::Point>>& candidates() const { return *this->shown; }
+	OcrPool& ocrPool() { return *this->ocr; }
+	KnownCars& knownCars() { return *this->known_cars; }
+	PlateTracker* plateTracker() { return this->tracker; }
+	MotionGate* motionGate() { return this->gate; }
+	LatencyBudget* latencyBudget() { return this->budget; }
+	DebugImages* debugImages() { return this->debug; }
+	void report(std::ostream &out);
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef EVENT_WRITER_HPP
+#define EVENT_WRITER_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class EventTag {
+	NONE,	// A single video
+	STREAM,	// Name of the stream first, with --streams
+	IMAGE	// Path of the image first, in batch mode
+};
+
+enum class EventFormat {
+	JSON,	// One JSON object per frame and line
+	CSV	// One row per match, frames without matches get one row with empty plate columns
+};
+
+std::string json_escape(const std::string &value);
+std::string csv_escape(const std::string &value);
+
+struct FrameEvent {
+	std::string stream;		// Name of the stream in multi-camera mode, the input in batch mode, empty otherwise
+	std::string image;		// Path of the image in batch mode
+	long frame = 0;
+	double position_ms = 0;		// Position in the stream as reported by the decoder
+	int64_t capture_us = 0;		// When the frame was captured, microseconds since 1970 UTC, 0 when unknown
+	double latency_ms = 0;		// From the frame being read until its result was ready
+	bool parking_valid = false;
+	bool id_valid = false;
+};
+
+/** Beskrivning:  Skriver resultatet för varje bildruta som strukturerad text, antingen JSON per rad eller CSV, till stdout eller en fil.
+*									Rektanglarna är i pixlar i den ursprungliga bildrutan
+* Argument 1:   const std::string& - sökväg till filen, "-" för stdout
+* Argument 2:   EventFormat - format på raderna
+* Argument 3:   EventTag - ifall raderna ska märkas med strömmens namn eller bildens sökväg, CSV får då en första kolumn stream eller image
+* Return:       EventWriter - EventWriter objekt
+* Exempel:
+*               EventWriter events("-", EventFormat::JSON)
+*               events.write(event, matches) => {"stream":"entrance","frame":12,"time_ms":480,"latency_ms":35.2,"parking_valid":true,"id_valid":true,"plates":[...]}
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class EventWriter {
+	std::ofstream file;
+	std::ostream *out;
+	EventFormat format;
+	EventTag tag;
+public:
+	EventWriter(const std::string &path, EventFormat format, EventTag tag = EventTag::NONE);
+	bool ok() const { return this->out != nullptr && this->out->good(); }
+	void write(const FrameEvent &event, const std::vector<Match> &matches);
+};
+
+#endif
@@ -7,6 +7,7 @@
 * Exempel:
 *               FileHandler fileHandler("known_cars.txt") => sätter privata variablen this->path till att vara "known_cars.txt" och skapar ett objekt (fileHandler)
 *               fileHandler.getIDs() => ["YAH088", "MSF492"] ifall filen i sökvägen this->path innehåller två rader med var sin av följande strängar: "YAH088" och "MSF492", i kronologisk ordning
+*               fileHandler.getPackedIDs() => samma rader men packade till heltal med pack_plate(), filen läses genom mmap
 *
 * By:           Vigor Turujlija Gamelius
 * Date:         2022-06-03
@@ -16,5 +17,6 @@ class FileHandler {
 public:
 	FileHandler(const char *path);
 	std::vector<std::string> getIDs();
+	std::vector<uint32_t> getPackedIDs();
  };
 #endif
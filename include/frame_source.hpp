@@ -0,0 +1,70 @@
+#ifndef FRAME_SOURCE_HPP
+#define FRAME_SOURCE_HPP
+
+#include <atomic>
+#include <ostream>
+
+enum class SamplingMode {
+	ALL,		// Every frame is analysed
+	STRIDE,		// Every n:th frame
+	FPS,		// A fixed number of frames per second of video
+	ADAPTIVE	// Between two rates, the higher while a plate is in view
+};
+
+struct SamplingConfig {
+	SamplingMode mode = SamplingMode::ALL;
+	int stride = 2;			// STRIDE: every n:th frame is analysed
+	double fps = 5;			// FPS: frames analysed per second of video, ADAPTIVE: the rate on an empty scene
+	double active_fps = 0;		// ADAPTIVE: the rate while a plate is in view, 0 for every frame
+	double hold_seconds = 2;	// ADAPTIVE: seconds of video the higher rate is kept after the last plate was read
+	double source_fps = 25;		// Used when the stream does not report its own frame rate
+};
+
+/** Beskrivning:  Läser de bildrutor som ska analyseras ur en videoström. Bildrutor som hoppas över tas med grab(), som avkodar paketet men låter bli
+*									att konvertera och kopiera bilden, och bara de bildrutor som analyseras hämtas med retrieve(). Vilka bildrutor som
+*									analyseras styrs av SamplingConfig. Med icke heltaliga intervall, till exempel 5 av 25 fps i en 30 fps ström, sparas
+*									resten så att det blir rätt antal bildrutor över tid. Tiden för grab() och retrieve() mäts var för sig så att
+*									besparingen kan redovisas. observe() kan anroppas från en annan tråd än read(). Med luma lämnas bara
+*									luminansen (Y) som en bild med en kanal, direkt från avkodaren när den kan det och annars konverterad här
+* Argument 1:   cv::VideoCapture& - referens till en öppen videoström
+* Argument 2:   SamplingConfig - läge och takt
+* Argument 3:   bool - true för att läsa bildrutorna i gråskala, lokalisering och ocr körs då på en kanal
+* Return:       FrameSource - FrameSource objekt
+* Exempel:
+*               FrameSource source(cap, config)
+*               source.read(frame) => true och nästa bildruta som ska analyseras, false när strömmen är slut
+*               source.observe(true) => en skylt lästes, med ADAPTIVE höjs takten
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class FrameSource {
+	cv::VideoCapture &cap;
+	SamplingConfig config;
+	double source_fps;
+	double owed = 0;				// Frames to advance that did not make a whole frame yet
+	long position = 0;				// Frames grabbed from the stream so far
+	std::atomic<long> last_plate{-1000000000};	// Position of the last frame a plate was read in
+	std::atomic<long> analysed_position{0};		// Position of the frame read() returned last
+	long frames_grabbed = 0;
+	long frames_retrieved = 0;
+	double grab_ms = 0;				// Time in grab() for all frames, and in retrieve() for the analysed ones
+	double retrieve_ms = 0;
+	bool luma;
+	bool native_luma = true;			// The decoder gives one channel itself, cleared at the first frame that has more
+	long luma_converted = 0;			// Frames converted here because the decoder gave colour anyway
+	cv::Mat decoded;				// Colour frame before conversion when the decoder cannot give luma
+
+	double interval() const;
+public:
+	FrameSource(cv::VideoCapture &cap, SamplingConfig config, bool luma = false);
+	bool read(cv::Mat &frame, int min_stride = 1);
+	void observe(bool plate_in_view);
+	double sourceFps() const { return this->source_fps; }
+	double positionMs() const { return this->cap.get(cv::CAP_PROP_POS_MSEC); }
+	long framesGrabbed() const { return this->frames_grabbed; }
+	long framesRetrieved() const { return this->frames_retrieved; }
+	void report(std::ostream &out);
+};
+
+#endif
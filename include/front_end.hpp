@@ -0,0 +1,32 @@
+#ifndef FRONT_END_HPP
+#define FRONT_END_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+struct FrontEndBand;
+
+#define FRONT_END_MIN_ROWS 32	// Fewest rows of a band when the count is picked automatically, the halo is up to 13 rows
+
+/* The frame sized images the bands read and write, all in the processing size */
+struct FrontEndFrame {
+	const uint8_t *gray;
+	size_t gray_step;
+	uint8_t *opened;		// Gray after the 4x4 open
+	size_t opened_step;
+	uint8_t *blackhat;
+	size_t blackhat_step;
+	uint16_t *magnitude;		// Scharr gradient, rows * cols without padding
+	uint8_t *blur;
+	size_t blur_step;
+	uint8_t *closed;		// Blurred gradient after the 13x5 close, thresholded by the caller
+	size_t closed_step;
+	int rows;
+	int cols;
+};
+
+void front_end_gradient(const FrontEndFrame &frame, FrontEndBand &band);
+void front_end_close(const FrontEndFrame &frame, const uint8_t *table, FrontEndBand &band);
+int front_end_otsu(const uint32_t *histogram, long pixels);
+
+#endif
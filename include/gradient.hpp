@@ -0,0 +1,15 @@
+#ifndef GRADIENT_HPP
+#define GRADIENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/* Largest horizontal Scharr response of an 8 bit image, 3 * 255 + 10 * 255 + 3 * 255 */
+#define SCHARR_X_MAX 4080
+
+void scharr_x_row(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint16_t *magnitude, int cols, uint16_t &hi);
+void scharr_x_table(uint16_t hi, uint8_t *table);
+void fused_scharr_x(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step, uint16_t *magnitude, int rows, int cols);
+const char* fused_scharr_x_kernel();
+
+#endif
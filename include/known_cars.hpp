@@ -0,0 +1,54 @@
+#ifndef KNOWN_CARS_HPP
+#define KNOWN_CARS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define PLATE_LENGTH 6
+
+bool pack_plate(const char *plate, size_t length, uint32_t &packed);
+
+/** Beskrivning:  Index över godkänt parkerade bilar. Varje registreringsskylt packas till ett 32 bitars heltal och läggs i en hashtabell med öppen adressering,
+*									så att en uppslagning tar konstant tid oavsett hur lång listan är. Filen kan bevakas och laddas om medan videon körs,
+*									den nya tabellen byts in atomiskt så att pågående uppslagningar aldrig ser en halvfärdig tabell
+* Argument 1:   const char* - sökväg till textfil med en registreringsskylt per rad
+* Return:       KnownCars - KnownCars objekt
+* Exempel:
+*               KnownCars known_cars("known_cars.txt")
+*               known_cars.contains("YAJ066") => true ifall "YAJ066" finns i filen
+*               known_cars.watch(1000) => filen kontrolleras varje sekund och laddas om när den ändrats
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class KnownCars {
+	struct Table {
+		std::vector<uint32_t> slots;
+		uint32_t mask = 0;
+		size_t count = 0;
+	};
+
+	std::string path;
+	std::shared_ptr<const Table> table;
+	std::thread watcher;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+
+	void poll(int interval_ms);
+public:
+	KnownCars(const char *path);
+	~KnownCars();
+	bool load();
+	void watch(int interval_ms);
+	bool contains(const std::string &plate) const;
+	size_t size() const;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef LATENCY_BUDGET_HPP
+#define LATENCY_BUDGET_HPP
+
+#include <atomic>
+#include <ostream>
+
+struct LatencyBudgetConfig {
+	double budget_ms = 40;		// Deadline for one frame
+	int width = 512;		// Starting processing width, the long side of the frame is scaled to this
+	int min_width = 256;
+	int max_width = 1024;
+	int width_step = 64;
+	int keep = 5;			// Starting number of candidates sent to OCR
+	int min_keep = 1;
+	int max_keep = 8;
+	int max_stride = 4;		// At most every n:th frame is processed when even the cheapest settings are too slow
+	float headroom = 0.7f;		// Quality goes up again when the frames take less than this share of the budget
+	float smoothing = 0.2f;		// Weight of the newest frame in the running averages
+	int cooldown = 10;		// Frames between two adjustments, so each change is measured before the next
+};
+
+/** Beskrivning:  Styr kvaliteten efter en tidsbudget per bildruta. Mäter hur lång tid lokalisering och ocr tar och sänker först
+*									det som kostar mest, upplösningen för lokalisering eller antalet kandidater till ocr, och sist hur många bildrutor
+*									som körs. Finns det tid över höjs kvaliteten igen i omvänd ordning
+* Argument 1:   LatencyBudgetConfig - budget och gränser
+* Return:       LatencyBudget - LatencyBudget objekt
+* Exempel:
+*               LatencyBudget budget(config)
+*               budget.observe(52.0, 20.0, 30.0) => antalet kandidater sänks eftersom ocr tar mest tid
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class LatencyBudget {
+	LatencyBudgetConfig config;
+	double frame_ms = 0;
+	double locate_ms = 0;
+	double ocr_ms = 0;
+	long frames = 0;
+	long frames_over = 0;
+	long adjustments = 0;
+	int since_adjustment = 0;
+	std::atomic<int> width;
+	std::atomic<int> keep;
+	std::atomic<int> stride;
+	bool degrade();
+	bool upgrade();
+public:
+	LatencyBudget(LatencyBudgetConfig config);
+	void observe(double frame_ms, double locate_ms, double ocr_ms);
+	int processingWidth() const { return this->width.load(std::memory_order_relaxed); }
+	int candidates() const { return this->keep.load(std::memory_order_relaxed); }
+	int frameStride() const { return this->stride.load(std::memory_order_relaxed); }
+	void report(std::ostream &out);
+};
+
+#endif
@@ -1,3 +1,39 @@
-std::vector<std::vector<cv::Point>> locateCandidates(cv::Mat &colorMat);
-bool compareContourAreas (std::vector<cv::Point>& contour1, std::vector<cv::Point>& contour2);
+#ifndef MAIN_HPP
+#define MAIN_HPP
+
+class OcrPool;
+class PlateTracker;
+class MotionGate;
+class KnownCars;
+class DetectionContext;
+class LatencyBudget;
+class DebugFrame;
+class DebugImages;
+class FrameSource;
+
+struct Match {
+	cv::Rect rectangle;
+	std::string id;
+	bool id_valid;
+	bool parking_valid;
+};
+
+std::vector<std::vector<cv::Point>>& locateCandidates(cv::Mat &colorMat, DetectionContext &ctx);
+std::vector<std::vector<cv::Point>>& locateCandidatesInRegion(cv::Mat &frame, cv::Rect roi, DetectionContext &ctx);
+void locate_resize(cv::Mat &frame, DetectionContext &ctx);
+void locate_morphology(DetectionContext &ctx);
+void locate_sobel(DetectionContext &ctx);
+void locate_threshold(DetectionContext &ctx);
+void locate_front_end(DetectionContext &ctx);
+std::vector<std::vector<cv::Point>>& locate_contours(DetectionContext &ctx);
 void drawCandidates(cv::Mat &frame, std::vector<std::vector<cv::Point>> &candidates);
+std::vector<Match> extract_ids(OcrPool &ocr, cv::Mat &frame, std::vector<std::vector<cv::Point>> &candidates, KnownCars &known_cars, PlateTracker *tracker = NULL, DebugFrame *debug = NULL);
+void drawMatches(cv::Mat &frame, const std::vector<Match> &matches, const std::vector<std::vector<cv::Point>> &candidates);
+void run_ocr(tesseract::TessBaseAPI *api, cv::Mat input, std::string &answer);
+void run_ocr_regions(tesseract::TessBaseAPI *api, cv::Mat &frame, std::vector<cv::Rect> &rects, std::vector<std::string> &answers);
+void run_ocr_montage(tesseract::TessBaseAPI *api, cv::Mat &frame, std::vector<cv::Rect> &rects, std::vector<std::string> &answers, DebugFrame *debug = NULL);
+void debug_img(DebugFrame *debug, const char* name, cv::Mat &img);
+bool valid_chars(std::string &s);
+void parse_answer(std::string answer, std::string &answer_parsed);
+const char* flag_value(const char *arg, const char *flag);
+#endif
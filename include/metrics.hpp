@@ -0,0 +1,170 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define HISTOGRAM_BUCKETS 14
+
+/** Beskrivning:  Histogram över latens med fasta gränser, varje observation är några atomiska additioner utan lås
+* Return:       Histogram - Histogram objekt
+* Exempel:
+*               histogram.observe(0.004) => räknas i alla hinkar från 0.005 sekunder och uppåt
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class Histogram {
+	std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS + 1]; // Last bucket is +Inf
+	std::atomic<uint64_t> sum_ns{0};
+public:
+	static const double bounds[HISTOGRAM_BUCKETS]; // Upper bounds in seconds
+
+	Histogram();
+	void observe(double seconds);
+	void write(std::string &out, const char *name, const char *labels) const;
+};
+
+/** Beskrivning:  Räknare som bara kan öka
+* Exempel:
+*               counter.add(3) => värdet ökar med tre
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class Counter {
+	std::atomic<uint64_t> value{0};
+public:
+	void add(uint64_t n = 1) { this->value.fetch_add(n, std::memory_order_relaxed); }
+	uint64_t get() const { return this->value.load(std::memory_order_relaxed); }
+};
+
+/** Beskrivning:  Mätare som kan sättas till ett godtyckligt värde, till exempel hur många element en kö har
+* Exempel:
+*               gauge.set(4) => värdet är fyra
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class Gauge {
+	std::atomic<int64_t> value{0};
+public:
+	void set(int64_t n) { this->value.store(n, std::memory_order_relaxed); }
+	int64_t get() const { return this->value.load(std::memory_order_relaxed); }
+};
+
+/** Beskrivning:  Mätvärden för en ström när flera kameror körs i samma process, exporteras med etiketten stream
+* Exempel:
+*               stream.metrics.frames.add() => anpr_stream_frames_total{stream="entrance"} ökar med ett
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+struct StreamMetrics {
+	std::string name;
+	Histogram frame;
+	Counter frames;
+	Counter frames_dropped;
+	Counter valid_reads;
+	Counter parking_valid;
+	Gauge queue;
+};
+
+struct Metrics {
+	/* Latency per stage, frame is the whole of anpr() or decode to render in the pipeline */
+	Histogram frame;
+	Histogram locate;
+	Histogram extract_ids;
+	Histogram ocr;
+	Histogram ocr_fast;			// PlateClassifier attempts, hits and misses
+
+	Counter frames;
+	Counter frames_grabbed;			// Frames taken from the stream by FrameSource, analysed or not
+	Counter frames_retrieved;		// Frames FrameSource decoded into an image for analysis
+	Counter candidates_found;
+	Counter candidates_rejected_rect;	// Contour area too far from its bounding box, RECT_DIFF
+	Counter candidates_rejected_aspect;	// Aspect ratio outside MIN_AR and MAX_AR
+	Counter ocr_calls;
+	Counter ocr_fast_hits;			// Candidates read by PlateClassifier without Tesseract
+	Counter ocr_fast_misses;		// Candidates PlateClassifier passed on to Tesseract
+	Counter valid_reads;
+	Counter parking_valid;
+
+	/* Pipeline queue depths, sampled by the render step */
+	Gauge queue_decoded;
+	Gauge queue_located;
+	Gauge queue_recognized;
+
+	/* Settings chosen by the latency budget */
+	Gauge processing_width;
+	Gauge candidate_limit;
+	Gauge frame_stride;
+
+	/* Per stream metrics in multi-camera mode, registered while the streams run */
+	mutable std::mutex streams_mutex;
+	std::vector<const StreamMetrics*> streams;
+	void addStream(const StreamMetrics *stream);
+	void removeStream(const StreamMetrics *stream);
+
+	std::string exposition() const;
+};
+
+extern Metrics METRICS;
+
+double percentile(const std::vector<double> &sorted, double p);
+
+/** Beskrivning:  Mäter tiden från att objektet skapas tills det förstörs och lägger den i ett histogram
+* Argument 1:   Histogram& - referens till histogrammet
+* Return:       ScopedTimer - ScopedTimer objekt
+* Exempel:
+*               { ScopedTimer timer(METRICS.locate); locateCandidates(frame); } => tiden för locateCandidates läggs i METRICS.locate
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class ScopedTimer {
+	Histogram &histogram;
+	std::chrono::steady_clock::time_point start;
+public:
+	ScopedTimer(Histogram &histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+	~ScopedTimer() { this->histogram.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - this->start).count()); }
+};
+
+/** Beskrivning:  Exporterar METRICS i Prometheus textformat, antingen via en lokal http server på /metrics eller genom att skriva om en fil med jämna mellanrum.
+*									Filen skrivs först till en temporär fil som sedan döps om, så att en läsare aldrig ser en halv fil
+* Argument 1:   int - port för http servern på 127.0.0.1, 0 för ingen server
+* Argument 2:   const std::string& - sökväg till filen, tom för ingen fil
+* Argument 3:   int - millisekunder mellan varje gång filen skrivs
+* Return:       MetricsExporter - MetricsExporter objekt
+* Exempel:
+*               MetricsExporter exporter(9100, "", 0) => curl localhost:9100/metrics ger alla mätvärden
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class MetricsExporter {
+	int port;
+	std::string path;
+	int interval_ms;
+	int server_fd = -1;
+	std::thread server;
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::atomic<bool> stopping{false};
+
+	void serve();
+	void write_file();
+public:
+	MetricsExporter(int port, const std::string &path, int interval_ms);
+	~MetricsExporter();
+	bool ok() const { return this->port == 0 || this->server_fd >= 0; }
+};
+
+#endif
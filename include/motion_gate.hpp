@@ -0,0 +1,50 @@
+#ifndef MOTION_GATE_HPP
+#define MOTION_GATE_HPP
+
+#include <vector>
+
+struct MotionGateConfig {
+	int width = 160;		// Width of the downsampled frame the change detection runs on
+	int pixel_threshold = 25;	// Grey level difference to the background that counts as change
+	float min_changed = 0.002f;	// Fraction of changed pixels below which the frame is skipped
+	float full_frame = 0.4f;	// Above this fraction of the frame the whole frame is processed
+	float margin = 0.1f;		// Padding around the changed region, relative to the frame size
+	double learning_rate = 0.05;	// How fast the running background follows the scene
+};
+
+/** Beskrivning:  Billig detektering av förändring i bilden som körs före anpr(). Bildrutan skalas ner och jämförs mot en löpande bakgrundsmodell,
+*									är bilden oförändrad hoppas den över och har bara en del av bilden ändrats begränsas detekteringen till den delen
+* Argument 1:   MotionGateConfig - gränser för vad som räknas som förändring
+* Return:       MotionGate - MotionGate objekt
+* Exempel:
+*               MotionGate gate(config)
+*               gate.check(frame, roi) => false ifall bilden är oförändrad, annars true och roi sätts till den del av bilden som ändrats
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class MotionGate {
+	MotionGateConfig config;
+	cv::Mat small;
+	cv::Mat background;
+	cv::Mat background_8u;
+	cv::Mat mask;
+	long frames = 0;
+	long frames_skipped = 0;
+	long frames_partial = 0;
+	double pixels = 0;
+	double pixels_skipped = 0;
+public:
+	/* Result of the last processed frame, shown again while the scene is static */
+	std::vector<Match> held_matches;
+	std::vector<std::vector<cv::Point>> held_candidates;
+	bool held_parking_valid = false;
+	bool held_id_valid = false;
+
+	MotionGate(MotionGateConfig config);
+	bool check(const cv::Mat &frame, cv::Rect &roi);
+	void hold(const cv::Rect &roi, std::vector<Match> &matches, std::vector<std::vector<cv::Point>> &candidates);
+	void report(std::ostream &out);
+};
+
+#endif
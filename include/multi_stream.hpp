@@ -0,0 +1,103 @@
+#ifndef MULTI_STREAM_HPP
+#define MULTI_STREAM_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct StreamConfig {
+	std::string name;		// Tags the results and metrics of the stream
+	std::string source;		// File, URL or device index
+	std::string known_cars;		// Known cars list, streams with the same list share one index
+	int priority = 1;		// Share of the workers relative to the other streams
+};
+
+bool read_stream_config(const std::string &path, std::vector<StreamConfig> &streams);
+
+struct MultiStreamConfig {
+	PipelineConfig pipeline;	// Queue size per stream, number of workers and backpressure
+	bool track = false;		// One PlateTracker per stream
+	TrackerConfig tracker;
+	bool motion = false;		// One MotionGate per stream
+	MotionGateConfig motion_config;
+	SamplingConfig sampling;	// One FrameSource per stream, each with the stream's own frame rate
+	bool luma = false;		// Read the streams in grayscale
+	int reload_interval = 1000;	// How often the known cars lists are checked for changes, 0 to never reload them
+};
+
+/** Beskrivning:  En ström i MultiStream med allt som hör till just den kameran: videoström, lista över godkända bilar, spårning,
+*									sampling, förändringsdetektering, arbetsyta för lokalisering och kön av avkodade bildrutor
+* Return:       Stream - Stream objekt
+* Exempel:
+*               stream->config.name => "entrance"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+struct Stream {
+	StreamConfig config;
+	cv::VideoCapture cap;
+	FrameSource *source = NULL;	// Frames to analyse from cap, the decoder reads and the worker holding the stream observes
+	KnownCars *known_cars = NULL;
+	PlateTracker *tracker = NULL;
+	MotionGate *gate = NULL;
+	DetectionContext detection;	// Only the worker holding the stream touches it
+	StreamMetrics metrics;
+	std::deque<FrameJob> ready;	// Decoded frames waiting for a worker
+	bool busy = false;		// A worker has a frame of this stream, frames of a stream are processed one at a time and in order
+	bool finished = false;		// The decoder has stopped
+	double pass = 0;		// Stride scheduling, the stream with the lowest pass is served next
+	long seq = 0;
+	std::thread decoder;
+};
+
+/** Beskrivning:  Kör anpr på flera strömmar i samma process. Varje ström avkodas i en egen tråd in i en egen kö, och en gemensam pool av arbetare
+*									tar bildrutor från den ström som står på tur. Turordningen följer strömmarnas prioritet med stride scheduling, så en ström
+*									med prioritet 2 får dubbelt så många bildrutor körda som en med prioritet 1 när båda har mer än arbetarna hinner med.
+*									En ledig arbetare tar alltid från någon ström som har väntande bildrutor, så ingen arbetare står still medan en annan
+*									ström ligger efter. Tesseract motorerna i OcrPool delas av alla strömmar
+* Argument 1:   MultiStreamConfig - köer, antal arbetare, samt spårning och förändringsdetektering per ström
+* Argument 2:   OcrPool& - referens till den gemensamma poolen av Tesseract motorer
+* Argument 3:   DebugImages* - pekare till skrivaren av debug bilder som alla strömmar delar, eller NULL
+* Return:       MultiStream - MultiStream objekt
+* Exempel:
+*               MultiStream streams(config, ocr, NULL)
+*               streams.add(stream_config) => true ifall källan kunde öppnas
+*               streams.run(on_frame) => on_frame anroppas i den anroppande tråden för varje färdig bildruta från alla strömmar
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class MultiStream {
+	MultiStreamConfig config;
+	OcrPool &ocr;
+	DebugImages *debug;
+	std::vector<Stream*> streams;
+	std::map<std::string, KnownCars*> known_cars;	// By path, shared between streams
+	std::mutex mutex;
+	std::condition_variable has_work;
+	std::condition_variable has_room;
+	double virtual_time = 0;
+	bool stopping = false;
+
+	void decode(Stream *stream);
+	void work(BoundedQueue<std::pair<Stream*, FrameJob>> &results);
+	Stream* next();
+	bool done();
+	void process(Stream *stream, FrameJob &job);
+public:
+	MultiStream(MultiStreamConfig config, OcrPool &ocr, DebugImages *debug = NULL);
+	~MultiStream();
+	bool add(const StreamConfig &stream_config);
+	size_t size() const { return this->streams.size(); }
+	void run(std::function<bool(Stream&, FrameJob&)> on_frame);
+	void report(std::ostream &out);
+};
+
+#endif
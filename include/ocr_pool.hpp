@@ -0,0 +1,94 @@
+#ifndef OCR_POOL_HPP
+#define OCR_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define PLATE_CHARSET "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789" // Whitelist for the frame and montage modes
+
+enum class OcrMode {
+	CROP,		// Every candidate is its own image with full layout analysis
+	FRAME,		// The frame is set once per engine and every candidate is a rectangle of it, read as a single line
+	MONTAGE		// The candidates are scaled to the same height and stacked into one image that is read in one pass
+};
+
+struct OcrPoolConfig {
+	int size = 4;			// Number of workers, each with its own TessBaseAPI
+	std::string language = "swe";
+	bool warmup = true;		// Run one recognition per engine at startup
+	std::string model;		// PlateClassifier model for the fast path, empty to always run Tesseract
+	float min_confidence = 0.25f;	// Fast reads less certain than this go to Tesseract
+	OcrMode mode = OcrMode::CROP;
+};
+
+class PlateClassifier;
+
+/** Beskrivning:  Pool av trådar där varje tråd äger ett eget initierat Tesseract api, så att flera kandidater från samma bildruta kan köras genom ocr samtidigt.
+*									All initiering sker i konstruktorn så att kostnaden betalas vid uppstart och inte vid första bildrutan.
+*									Med en modell i konfigurationen läses varje utklipp först av PlateClassifier och Tesseract körs bara när den är osäker
+*									I lägena FRAME och MONTAGE delas bildrutans kandidater upp i en grupp per tråd istället för en uppgift per kandidat
+* Argument 1:   OcrPoolConfig - antal trådar, språk, läge, ifall motorerna ska värmas upp och eventuell modell för den snabba vägen
+* Return:       OcrPool - OcrPool objekt
+* Exempel:
+*               OcrPool pool(config) => startar config.size trådar med var sitt Tesseract api
+*               pool.ok() => false ifall något api inte kunde initieras
+*               pool.recognize(frame, rects, answers) => answers[i] sätts till ocr resultatet för rects[i] i frame
+*               pool.report(std::cout) => hur ofta den snabba vägen räckte och hur mycket tid det sparade
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class OcrPool {
+	struct Batch {
+		size_t remaining = 0;
+		std::condition_variable done;
+	};
+	struct Task {
+		cv::Mat frame;
+		std::vector<cv::Rect> rects;		// One candidate in CROP mode, a share of the frame's candidates otherwise
+		std::vector<std::string*> answers;
+		DebugFrame *debug;
+		Batch *batch;
+	};
+
+	OcrPoolConfig config;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable has_work;
+	std::condition_variable ready;
+	std::deque<Task> tasks;
+	int started = 0;
+	int failed = 0;
+	bool stopping = false;
+	PlateClassifier *classifier = NULL;
+	bool model_failed = false;
+
+	/* Fast path statistics, the time of the fast path includes the attempts that fell back to Tesseract */
+	std::atomic<uint64_t> fast_hits{0};
+	std::atomic<uint64_t> fast_misses{0};
+	std::atomic<uint64_t> fast_ns{0};
+	std::atomic<uint64_t> tesseract_runs{0};
+	std::atomic<uint64_t> tesseract_ns{0};
+
+	void work();
+	void read(tesseract::TessBaseAPI *api, Task &task);
+	bool read_fast(const cv::Mat &crop, std::string &answer);
+public:
+	OcrPool(OcrPoolConfig config);
+	~OcrPool();
+	bool ok() const { return this->failed == 0 && !this->model_failed; }
+	int size() const { return this->config.size; }
+	void recognize(cv::Mat &frame, std::vector<cv::Rect> &rects, std::vector<std::string> &answers, DebugFrame *debug = NULL);
+	void report(std::ostream &out);
+};
+
+void configure_ocr(tesseract::TessBaseAPI *api, OcrMode mode);
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+enum class Backpressure {
+	BLOCK,		// Producer waits until there is room in the queue
+	DROP_OLDEST	// Producer evicts the oldest element in the queue
+};
+
+/** Beskrivning:  Trådsäker kö med ett begränsat antal platser, används för att koppla ihop stegen i pipelinen.
+*									När kön är full blockerar push() eller kastar det äldsta elementet beroende på vald Backpressure
+* Argument 1:   size_t - max antal element i kön
+* Argument 2:   Backpressure - vad som ska hända när kön är full
+* Return:       BoundedQueue - BoundedQueue objekt
+* Exempel:
+*               BoundedQueue<int> queue(4, Backpressure::BLOCK) => kö med plats för fyra heltal
+*               queue.push(1) => true så länge kön inte är stängd
+*               queue.pop(value) => false när kön är stängd och tom, annars true och value sätts
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+template <typename T>
+class BoundedQueue {
+	std::mutex mutex;
+	std::condition_variable not_empty;
+	std::condition_variable not_full;
+	std::deque<T> items;
+	size_t capacity;
+	Backpressure policy;
+	bool closed = false;
+public:
+	BoundedQueue(size_t capacity, Backpressure policy) : capacity(capacity > 0 ? capacity : 1), policy(policy) {}
+
+	bool push(T item, std::optional<T> *dropped = nullptr) {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		if (this->policy == Backpressure::BLOCK) {
+			this->not_full.wait(lock, [this] { return this->closed || this->items.size() < this->capacity; });
+		} else if (!this->closed && this->items.size() >= this->capacity) {
+			if (dropped != nullptr)
+				*dropped = std::move(this->items.front());
+			this->items.pop_front();
+		}
+		if (this->closed)
+			return false;
+		this->items.push_back(std::move(item));
+		lock.unlock();
+		this->not_empty.notify_one();
+		return true;
+	}
+
+	bool pop(T &item) {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->not_empty.wait(lock, [this] { return this->closed || !this->items.empty(); });
+		if (this->items.empty())
+			return false; // Closed and drained
+		item = std::move(this->items.front());
+		this->items.pop_front();
+		lock.unlock();
+		this->not_full.notify_one();
+		return true;
+	}
+
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->closed = true;
+		}
+		this->not_empty.notify_all();
+		this->not_full.notify_all();
+	}
+
+	size_t size() {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->items.size();
+	}
+};
+
+struct FrameJob {
+	long seq = 0;
+	bool dropped = false;	// Tombstone for a frame evicted by the backpressure policy
+	cv::Mat frame;
+	bool unchanged = false;	// Motion gate found nothing new, reuse the previous result
+	cv::Rect roi;		// Part of the frame the motion gate wants searched
+	DebugFrame *debug = NULL;	// Debug images of the frame, NULL when it is not saved
+	std::vector<std::vector<cv::Point>> candidates;
+	std::vector<Match> matches;
+	bool parking_valid = false;
+	bool id_valid = false;
+	std::chrono::steady_clock::time_point start;
+	double position_ms = 0;	// Position in the stream when the frame was read
+	double locate_ms = 0;	// Time spent in the detection and OCR stages, for the latency budget
+	double ocr_ms = 0;
+};
+
+struct PipelineConfig {
+	size_t queue_size = 4;
+	int detect_threads = 2;
+	Backpressure backpressure = Backpressure::BLOCK;
+	int processing_width = PROCESSING_WIDTH;	// Used when there is no latency budget
+	int bands = 0;					// Parallel bands of the detection front-end, 0 picks from the threads
+};
+
+/** Beskrivning:  Kör anpr algoritmen som en pipeline där avkodning, lokalisering av kandidater, ocr och utritning körs i egna trådar
+*									sammankopplade med köer av typen BoundedQueue. Resultaten lämnas tillbaka i samma ordning som bildrutorna lästes in
+* Argument 1:   PipelineConfig - köstorlek, antal trådar för lokalisering och backpressure policy
+* Argument 2:   OcrPool& - referens till poolen av Tesseract motorer som ocr steget använder
+* Argument 3:   KnownCars& - referens till index över godkänt parkerade bilar
+* Argument 4:   PlateTracker* - pekare till spårning mellan bildrutor, eller NULL. Ocr steget kör bildrutorna i ordning så spårningen fungerar som i seriellt läge
+* Argument 5:   MotionGate* - pekare till förändringsdetektering, eller NULL. Körs i avkodningstråden innan bildrutan köas
+* Argument 6:   LatencyBudget* - pekare till styrningen efter tidsbudget, eller NULL. Matas med tiderna i utritningssteget
+* Argument 7:   DebugImages* - pekare till skrivaren av debug bilder, eller NULL. Varje bildruta tar sina bilder med sig genom stegen
+* Return:       Pipeline - Pipeline objekt
+* Exempel:
+*               Pipeline pipeline(config, ocr, known_cars, tracker, gate, budget, NULL)
+*               pipeline.run(source, on_frame) => on_frame anroppas i ordning för varje färdig bildruta tills strömmen tar slut eller on_frame returnerar false
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class Pipeline {
+	PipelineConfig config;
+	OcrPool &ocr;
+	KnownCars &known_cars;
+	PlateTracker *tracker;
+	MotionGate *gate;
+	LatencyBudget *budget;
+	DebugImages *debug;
+	std::atomic<bool> stopping{false};
+	std::atomic<long> frames_read{0};
+	std::atomic<long> frames_dropped{0};
+
+	void decode(FrameSource &source, BoundedQueue<FrameJob> &decoded, BoundedQueue<FrameJob> &located);
+	void locate(BoundedQueue<FrameJob> &decoded, BoundedQueue<FrameJob> &located);
+	void recognize(BoundedQueue<FrameJob> &located, BoundedQueue<FrameJob> &recognized);
+public:
+	Pipeline(PipelineConfig config, OcrPool &ocr, KnownCars &known_cars, PlateTracker *tracker, MotionGate *gate, LatencyBudget *budget, DebugImages *debug = NULL);
+	void run(FrameSource &source, std::function<bool(FrameJob&)> on_frame);
+	long framesRead() const { return this->frames_read; }
+	long framesDropped() const { return this->frames_dropped; }
+};
+
+#endif
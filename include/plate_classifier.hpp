@@ -0,0 +1,40 @@
+#ifndef PLATE_CLASSIFIER_HPP
+#define PLATE_CLASSIFIER_HPP
+
+#include <string>
+#include <vector>
+
+#define GLYPH_WIDTH 12		// Size every character is scaled to before it is compared
+#define GLYPH_HEIGHT 20
+#define SEGMENT_HEIGHT 64	// Height the crop is scaled to before segmentation, so the size limits are in fixed pixels
+
+/** Beskrivning:  Snabb teckenigenkänning för registreringsskyltar. Utklippet delas upp i tecken med sammanhängande komponenter och varje tecken
+*									jämförs med närmaste granne bland inlärda tecken. Säkerheten är hur mycket närmare den bästa klassen är än den näst bästa,
+*									och är den för låg för något tecken ska Tesseract köras istället. Modellen tränas med anpr_train_ocr från märkta utklipp
+* Argument 1:   float - lägsta säkerhet för att svaret ska användas, mellan 0 och 1
+* Return:       PlateClassifier - PlateClassifier objekt
+* Exempel:
+*               PlateClassifier classifier(0.25f)
+*               classifier.load("ocr_model.yml") => true ifall modellen kunde läsas
+*               classifier.classify(crop, answer) => true och answer = "YAJ066" ifall alla sex tecken är säkra nog
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class PlateClassifier {
+	cv::Mat samples;		// One row of GLYPH_WIDTH * GLYPH_HEIGHT floats per learned character
+	std::string labels;		// Character of each row in samples
+	float min_confidence;
+public:
+	PlateClassifier(float min_confidence = 0.25f);
+	bool load(const std::string &path);
+	bool save(const std::string &path) const;
+	size_t size() const { return this->labels.size(); }
+	void add(const cv::Mat &glyph, char label);
+	char nearest(const cv::Mat &glyph, float &confidence) const;
+	bool classify(const cv::Mat &crop, std::string &answer, float *confidence = NULL) const;
+};
+
+size_t segment_plate(const cv::Mat &crop, std::vector<cv::Mat> &glyphs);
+
+#endif
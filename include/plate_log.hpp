@@ -0,0 +1,137 @@
+#ifndef PLATE_LOG_HPP
+#define PLATE_LOG_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define PLATE_ID_VALID		0x01
+#define PLATE_PARKING_VALID	0x02
+#define PLATE_CAPTURE_TIME	0x04	// time_us is when the frame was captured, not when the record was written
+
+/* One match as stored in a segment, host byte order. The layout is the file format, do not reorder */
+struct PlateRecord {
+	int64_t time_us;		// Capture time of the frame, or the wall clock when it was written if unknown. Microseconds since 1970 UTC
+	int64_t frame;
+	double position_ms;		// Position in the stream as reported by the decoder
+	uint64_t plate;			// Packed with pack_plate(), 0 when no valid plate was read
+	int32_t x, y, width, height;	// Rectangle in frame pixels
+	uint32_t stream;		// Line in streams.txt, 0 for a single unnamed video
+	uint8_t flags;			// PLATE_ID_VALID, PLATE_PARKING_VALID and PLATE_CAPTURE_TIME
+	uint8_t reserved[11];
+};
+static_assert(sizeof(PlateRecord) == 64, "PlateRecord is the on-disk format");
+
+/* Entry in the index of a sealed segment, sorted by plate and then time */
+struct PlateIndexEntry {
+	uint64_t plate;
+	int64_t time_us;
+	uint32_t record;		// Record number in the segment's log
+	uint32_t reserved;
+};
+static_assert(sizeof(PlateIndexEntry) == 24, "PlateIndexEntry is the on-disk format");
+
+/* Entry in segments.idx, appended when a segment is sealed */
+struct PlateSegmentEntry {
+	uint32_t number;
+	uint32_t reserved;
+	int64_t first_us;
+	int64_t last_us;
+	uint64_t records;
+};
+static_assert(sizeof(PlateSegmentEntry) == 32, "PlateSegmentEntry is the on-disk format");
+
+uint64_t pack_plate(const std::string &plate);
+std::string unpack_plate(uint64_t packed);
+bool parse_time(const char *value, int64_t &time_us);
+
+struct PlateLogConfig {
+	std::string directory;
+	long segment_records = 1 << 20;		// Records per segment, 64 MB
+	int segment_seconds = 3600;		// A segment is sealed at least this often, also when nothing is written, only the open segment lacks an index
+	bool valid_only = false;		// Only matches where a plate was read
+};
+
+/** Beskrivning:  Beständig logg över alla matchningar. Varje matchning skrivs som en PlateRecord med fast storlek i slutet av det öppna segmentet,
+*									en write() per bildruta, så att skrivningen är sekventiell. När ett segment är fullt eller gammalt nog förseglas det:
+*									ett index sorterat på skylt och tid skrivs bredvid loggen och segmentets tidsintervall läggs till i segments.idx.
+*									PlateLogReader slår sedan upp en skylt med binärsökning i de minnesmappade indexen utan att läsa loggarna.
+*									Segment som inte hann förseglas, till exempel efter en krasch, förseglas nästa gång loggen öppnas. Bara en process
+*									i taget kan skriva i en katalog, den håller ett lås på filen lock så länge loggen är öppen
+* Argument 1:   PlateLogConfig - katalog och storlek på segmenten
+* Return:       PlateLog - PlateLog objekt
+* Exempel:
+*               PlateLog log(config)
+*               log.write(event, matches) => en PlateRecord per matchning i "plates/000003.log"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class PlateLog {
+	PlateLogConfig config;
+	int lock_fd = -1;			// Holds the exclusive lock on the directory
+	int fd = -1;				// Open segment, -1 until the first record
+	uint32_t number = 0;			// Number of the open segment, or the last sealed one
+	std::vector<PlateIndexEntry> index;	// Index of the open segment, written when it is sealed
+	uint64_t records = 0;
+	int64_t first_us = 0;
+	int64_t last_us = 0;
+	std::chrono::steady_clock::time_point opened;	// When the open segment was created, it is sealed segment_seconds later
+	std::map<std::string, uint32_t> streams;
+	std::vector<PlateRecord> batch;
+	bool good = false;
+	std::mutex mutex;			// write() and the sealer thread
+	std::condition_variable wake;
+	bool stopping = false;
+	std::thread sealer;
+
+	uint32_t streamId(const std::string &name);
+	bool open(uint32_t number);
+	void seal();
+	void recover(uint32_t number);
+	void sealOnTime();
+public:
+	PlateLog(PlateLogConfig config);
+	~PlateLog();
+	PlateLog(const PlateLog&) = delete;
+	PlateLog& operator=(const PlateLog&) = delete;
+	bool ok() const { return this->good; }
+	void write(const FrameEvent &event, const std::vector<Match> &matches);
+};
+
+/** Beskrivning:  Läser en PlateLog katalog. segments.idx och segmentens index minnesmappas, så en sökning efter en skylt är en binärsökning
+*									per segment i tidsintervallet och läser sedan bara de poster som matchar ur loggarna
+* Argument 1:   const std::string& - katalogen
+* Return:       PlateLogReader - PlateLogReader objekt
+* Exempel:
+*               PlateLogReader reader("plates")
+*               reader.find(pack_plate("YAJ066"), from, to, on_record) => on_record anroppas för varje gång skylten sågs, i tidsordning
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class PlateLogReader {
+	std::string directory;
+	std::vector<std::string> stream_names;
+	const PlateSegmentEntry *segments = NULL;
+	size_t segment_count = 0;
+	size_t mapped_size = 0;
+	std::vector<uint32_t> open_segments;	// Logs without an index yet
+	bool good = false;
+public:
+	PlateLogReader(const std::string &directory);
+	~PlateLogReader();
+	bool ok() const { return this->good; }
+	size_t segmentCount() const { return this->segment_count; }
+	const std::vector<uint32_t>& openSegments() const { return this->open_segments; }
+	std::string streamName(uint32_t stream) const;
+	long find(uint64_t plate, int64_t from_us, int64_t to_us, std::function<void(const PlateRecord&)> on_record, bool scan_open = false);
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#define SHM_RING_MAGIC 0x52504e41	// "ANPR" in little endian
+#define SHM_RING_VERSION 1
+#define SHM_RING_MIN_SLOTS 3		// One the consumer holds, the newest frame and one the producer writes
+#define SHM_POLL_US 200			// How long the consumer sleeps between looks for a new frame
+
+enum class ShmFormat : uint32_t {
+	GRAY8 = 1,	// One byte per pixel
+	BGR24 = 2,	// Three bytes per pixel in OpenCV's channel order
+	NV12 = 3	// Y plane followed by interleaved U and V at half resolution, only the Y plane is read
+};
+
+/* Start of the shared memory object, the slots follow at SHM_RING_HEADER_SIZE. The layout is shared with other processes, do not reorder */
+struct ShmRingHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slot_count;
+	uint32_t reserved;
+	uint64_t slot_size;			// Bytes per slot including its ShmSlotHeader, a multiple of 64
+	std::atomic<uint64_t> latest;		// (frame << 16) | slot of the newest complete frame, 0 before the first
+	std::atomic<uint32_t> reader_slot;	// Slot the consumer holds + 1, 0 for none. The producer never writes it
+	std::atomic<uint32_t> closed;		// Set by the producer when it stops
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ring needs lock-free atomics that work between processes");
+
+#define SHM_RING_HEADER_SIZE 64
+static_assert(sizeof(ShmRingHeader) <= SHM_RING_HEADER_SIZE, "ShmRingHeader must fit before the first slot");
+
+/* Start of every slot, the image follows directly after it */
+struct ShmSlotHeader {
+	std::atomic<uint64_t> state;		// Odd while the producer writes the slot, otherwise 2 * frame
+	uint64_t frame;				// Sequence number from the producer, the first frame is 1
+	int64_t timestamp_us;			// Capture time from the producer, microseconds since 1970 UTC
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;			// Bytes per row, of the Y plane for NV12
+	uint32_t format;			// ShmFormat
+	uint8_t reserved[24];
+};
+static_assert(sizeof(ShmSlotHeader) == 64, "ShmSlotHeader is shared with other processes");
+
+struct ShmRingConfig {
+	std::string name;			// Shared memory object, a leading / is added when missing
+	int slots = 4;				// At least SHM_RING_MIN_SLOTS
+	int max_width = 1920;			// Largest frame a slot holds
+	int max_height = 1080;
+};
+
+std::string shm_object_name(const std::string &name);
+
+/** Beskrivning:  Skrivande sidan av ringbufferten, används av en fångstprocess och av anpr_shm_producer för tester. Objektet skapas på nytt
+*									så att en läsare av ett gammalt objekt aldrig ser storleken ändras. publish() skriver alltid till den äldsta platsen
+*									som läsaren inte håller, utan att vänta på läsaren: platsen markeras som upptagen, och håller läsaren den lämnas den
+*									tillbaka och nästa plats tas. Båda sidor skriver sin markering innan de läser den andras, så minst en ser den andra
+* Argument 1:   ShmRingConfig - namn, antal platser och största bildstorlek
+* Return:       ShmProducer - ShmProducer objekt
+* Exempel:
+*               ShmProducer producer(config)
+*               producer.publish(frame.data, frame.cols, frame.rows, frame.step, ShmFormat::BGR24, timestamp) => true och bildrutan är den nyaste i ringen
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class ShmProducer {
+	ShmRingConfig config;
+	std::string object;
+	uint8_t *memory = NULL;
+	size_t size = 0;
+	uint32_t slot = 0;			// Slot of the last published frame
+	uint64_t frame = 0;
+public:
+	ShmProducer(ShmRingConfig config);
+	~ShmProducer();
+	ShmProducer(const ShmProducer&) = delete;
+	ShmProducer& operator=(const ShmProducer&) = delete;
+	bool ok() const { return this->memory != NULL; }
+	bool publish(const uint8_t *data, int width, int height, size_t step, ShmFormat format, int64_t timestamp_us);
+	uint64_t framesPublished() const { return this->frame; }
+};
+
+/** Beskrivning:  Läsande sidan av ringbufferten. read() tar den nyaste bildrutan, håller dess plats så att producenten inte skriver över den
+*									och lämnar den som en cv::Mat direkt i det delade minnet utan kopiering. Bildrutor som producenten hann skriva över
+*									innan de lästes räknas som överhoppade. GRAY8 och Y planet i NV12 lämnas med en kanal, BGR24 i färg, eller med luma
+*									konverterad till gråskala i en egen buffert
+* Argument 1:   const std::string& - namnet på det delade minnet
+* Argument 2:   bool - true för att alltid lämna en kanal
+* Argument 3:   int - millisekunder utan ny bildruta innan read() ger upp, 0 för att vänta för evigt
+* Return:       ShmSource - ShmSource objekt
+* Exempel:
+*               ShmSource source("cam0", false, 5000)
+*               source.read(frame) => true och frame pekar in i det delade minnet tills nästa read() eller release()
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class ShmSource {
+	std::string object;
+	uint8_t *memory = NULL;
+	size_t size = 0;
+	bool luma;
+	int timeout_ms;
+	uint64_t last_frame = 0;
+	int64_t timestamp_us = 0;
+	bool holding = false;
+	long frames_read = 0;
+	long frames_skipped = 0;		// Overwritten before they could be read
+	long frames_converted = 0;		// Copied to convert colour to luma
+	cv::Mat converted;
+
+	ShmRingHeader* header() const { return (ShmRingHeader*) this->memory; }
+public:
+	ShmSource(const std::string &name, bool luma = false, int timeout_ms = 5000);
+	~ShmSource();
+	ShmSource(const ShmSource&) = delete;
+	ShmSource& operator=(const ShmSource&) = delete;
+	bool ok() const { return this->memory != NULL; }
+	bool read(cv::Mat &frame);
+	void release();
+	uint64_t frameNumber() const { return this->last_frame; }
+	int64_t timestampUs() const { return this->timestamp_us; }
+	void report(std::ostream &out);
+};
+
+#endif
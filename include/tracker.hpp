@@ -0,0 +1,61 @@
+#ifndef TRACKER_HPP
+#define TRACKER_HPP
+
+#include <deque>
+#include <string>
+#include <vector>
+
+struct TrackerConfig {
+	float min_iou = 0.3f;		// Minimum overlap for a candidate to continue a track
+	int history = 7;		// Number of recent reads that take part in the vote
+	int stable_votes = 4;		// Votes the leading read needs before the track counts as stable
+	int reverify_interval = 15;	// Frames between OCR runs on a stable track
+	int max_missing = 10;		// Frames a track survives without a matching candidate
+};
+
+struct Track {
+	int id;
+	cv::Rect rect;
+	cv::Point2f velocity;		// Smoothed movement of the rectangle centre per frame
+	std::deque<std::string> votes;
+	std::string consensus;
+	int consensus_votes = 0;
+	long last_seen = 0;
+	long last_ocr = -1;
+};
+
+/** Beskrivning:  Följer kandidater till registreringsskyltar mellan bildrutor genom att jämföra hur mycket rektanglarna överlappar, med hänsyn till rörelse.
+*									Varje spår röstar fram en registreringsskylt från de senaste ocr svaren, och ett stabilt spår behöver bara köra ocr då och då
+* Argument 1:   TrackerConfig - gränser för överlapp, röstning och omverifiering
+* Return:       PlateTracker - PlateTracker objekt
+* Exempel:
+*               PlateTracker tracker(config)
+*               tracker.update(rectangles, track_ids) => track_ids[i] är spåret för rectangles[i]
+*               tracker.needsOcr(track_ids[i]) => false ifall spåret är stabilt och nyligen verifierat
+*               tracker.vote(track_ids[i], "YAJ066") => "YAJ066" ifall det är den vanligaste läsningen i spåret
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+class PlateTracker {
+	TrackerConfig config;
+	std::vector<Track> tracks;
+	long frame = 0;
+	int next_id = 0;
+	long ocr_runs = 0;
+	long ocr_skips = 0;
+	cv::Rect region;		// Part of the frame the next update() searched, empty for all of it
+
+	Track* find(int id);
+public:
+	PlateTracker(TrackerConfig config);
+	void limitTo(const cv::Rect &region) { this->region = region; }
+	void update(std::vector<cv::Rect> &rectangles, std::vector<int> &track_ids);
+	bool needsOcr(int id);
+	std::string vote(int id, const std::string &plate);
+	std::string consensus(int id);
+	long ocrRuns() const { return this->ocr_runs; }
+	long ocrSkips() const { return this->ocr_skips; }
+};
+
+#endif
@@ -0,0 +1,715 @@
+#include <stdio.h>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <tesseract/baseapi.h>
+#include <leptonica/allheaders.h>
+#include <main.hpp>
+#include "debug_images.hpp"
+#include "detection_context.hpp"
+#include "front_end.hpp"
+#include "gradient.hpp"
+#include "known_cars.hpp"
+#include "metrics.hpp"
+#include "ocr_pool.hpp"
+#include "tracker.hpp"
+
+#define MIN_AR 1        // Minimum aspect ratio
+#define MAX_AR 6        // Maximum aspect ratio
+#define RECT_DIFF 2000  // Set the difference between contour and rectangle, in pixels of a frame squashed to 512x512
+#define MONTAGE_HEIGHT 48 // Height of every candidate in a montage
+#define MONTAGE_GAP 16    // White space around the candidates in a montage, keeps them on separate lines
+
+// Macros
+std::vector<std::string> _split(std::string s, std::string delimiter, bool avoid_double);
+
+/** Beskrivning:  Funktion som anroppar externt api för ocr (Optical character recognition) algirithmen
+* Argument 1:   tesseract::TessBaseAPI* - pekare till Tesseract api
+* Argument 2:   cv::Mat - bild att köra ocr algoritmen på
+* Argument 3:	  std::string& - referens till den sträng där svaret ska sparas, hittas ingen text sparas ingen text
+* Return:       void
+* Exempel:
+*               run_ocr(api, crop, answer) => void - svaret sparas i answer
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+void run_ocr(tesseract::TessBaseAPI *api, cv::Mat input, std::string &answer) {
+	ScopedTimer timer(METRICS.ocr);
+	METRICS.ocr_calls.add();
+	char *outText;
+
+	// Pass image data to tesseract
+	api->SetImage((uchar*)input.data, input.size().width, input.size().height, input.channels(), input.step1());
+
+	// Get OCR result
+	outText = api->GetUTF8Text();
+	answer = outText;
+
+	// Release memory
+	delete [] outText;
+}
+
+/** Beskrivning:  Kör ocr på flera rektanglar i samma bild. Bilden lämnas till Tesseract en gång och varje rektangel läses sedan med SetRectangle,
+*									på det sätt api:t är inställt, till exempel som en rad med configure_ocr(api, OcrMode::FRAME)
+* Argument 1:   tesseract::TessBaseAPI* - pekare till Tesseract api
+* Argument 2:   cv::Mat& - referens till hela bildrutan
+* Argument 3:   std::vector<cv::Rect>& - referens till rektanglarna att läsa, i bildrutans pixlar
+* Argument 4:   std::vector<std::string>& - referens där svaren sparas, samma ordning som rektanglarna
+* Return:       void
+* Exempel:
+*               run_ocr_regions(api, frame, rects, answers) => answers = ["YAJ066\n", ""]
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void run_ocr_regions(tesseract::TessBaseAPI *api, cv::Mat &frame, std::vector<cv::Rect> &rects, std::vector<std::string> &answers) {
+	answers.assign(rects.size(), "");
+	if (rects.empty())
+		return;
+
+	// Tesseract copies the image, so the whole frame is copied once instead of once per candidate
+	api->SetImage((uchar*)frame.data, frame.size().width, frame.size().height, frame.channels(), frame.step1());
+	for (size_t i = 0; i < rects.size(); i++) {
+		ScopedTimer timer(METRICS.ocr);
+		METRICS.ocr_calls.add();
+		api->SetRectangle(rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+		char *outText = api->GetUTF8Text();
+		if (outText != NULL) {
+			answers[i] = outText;
+			delete [] outText;
+		}
+	}
+}
+
+/** Beskrivning:  Kör ocr på flera rektanglar i ett enda pass. Rektanglarna skalas till samma höjd och staplas under varandra i en bild med vitt mellan,
+*									sedan delas Tesseracts textrader tillbaka till den rektangel de ligger i. Api:t bör läsa ett block av rader,
+*									till exempel med configure_ocr(api, OcrMode::MONTAGE)
+* Argument 1:   tesseract::TessBaseAPI* - pekare till Tesseract api
+* Argument 2:   cv::Mat& - referens till hela bildrutan
+* Argument 3:   std::vector<cv::Rect>& - referens till rektanglarna att läsa, i bildrutans pixlar
+* Argument 4:   std::vector<std::string>& - referens där svaren sparas, samma ordning som rektanglarna
+* Argument 5:   DebugFrame* - pekare till bildrutans debug bilder där montaget sparas, eller NULL
+* Return:       void
+* Exempel:
+*               run_ocr_montage(api, frame, rects, answers, NULL) => answers = ["YAJ066\n", ""]
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void run_ocr_montage(tesseract::TessBaseAPI *api, cv::Mat &frame, std::vector<cv::Rect> &rects, std::vector<std::string> &answers, DebugFrame *debug) {
+	ScopedTimer timer(METRICS.ocr);
+	METRICS.ocr_calls.add();
+	answers.assign(rects.size(), "");
+	if (rects.empty())
+		return;
+
+	/* One row per candidate, all with the same height */
+	std::vector<cv::Mat> rows(rects.size());
+	int width = 0;
+	for (size_t i = 0; i < rects.size(); i++) {
+		cv::Mat crop = frame(rects[i]);
+		cv::Mat gray;
+		if (crop.channels() == 3)
+			cv::cvtColor(crop, gray, cv::COLOR_BGR2GRAY);
+		else
+			gray = crop;
+		int row_width = std::max(1, cvRound(rects[i].width * (double) MONTAGE_HEIGHT / std::max(1, rects[i].height)));
+		cv::resize(gray, rows[i], cv::Size(row_width, MONTAGE_HEIGHT), 0, 0, cv::INTER_LINEAR);
+		width = std::max(width, row_width);
+	}
+	cv::Mat montage((int) rects.size() * (MONTAGE_HEIGHT + MONTAGE_GAP) + MONTAGE_GAP, width + 2 * MONTAGE_GAP, CV_8UC1, cv::Scalar(255));
+	for (size_t i = 0; i < rows.size(); i++)
+		rows[i].copyTo(montage(cv::Rect(MONTAGE_GAP, MONTAGE_GAP + (int) i * (MONTAGE_HEIGHT + MONTAGE_GAP), rows[i].cols, MONTAGE_HEIGHT)));
+	debug_img(debug, "montage", montage);
+
+	api->SetImage((uchar*)montage.data, montage.size().width, montage.size().height, montage.channels(), montage.step1());
+	if (api->Recognize(NULL) != 0)
+		return;
+	tesseract::ResultIterator *it = api->GetIterator();
+	if (it == NULL)
+		return;
+
+	/* Every text line belongs to the row its centre is in */
+	do {
+		int left, top, right, bottom;
+		if (!it->BoundingBox(tesseract::RIL_TEXTLINE, &left, &top, &right, &bottom))
+			continue;
+		char *text = it->GetUTF8Text(tesseract::RIL_TEXTLINE);
+		if (text == NULL)
+			continue;
+		int row = ((top + bottom) / 2 - MONTAGE_GAP / 2) / (MONTAGE_HEIGHT + MONTAGE_GAP);
+		if (row >= 0 && row < (int) answers.size()) {
+			if (!answers[row].empty())
+				answers[row] += " ";
+			answers[row] += text;
+		}
+		delete [] text;
+	} while (it->Next(tesseract::RIL_TEXTLINE));
+	delete it;
+}
+
+/** Beskrivning:  Tar emot en sträng och beslutar ifall den innehåller några felaktiga tecken
+* Argument 1:   std::string& - referens till en sträng
+* Return:       bool - true om strängen är fri från felaktiga tecken, false annars
+* Exempel:
+*               valid_chars("YAH088") => true
+*               valid_chars("YAH08#") => false
+*               valid_chars("YaH088") => false
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+bool valid_chars(std::string &s) {
+	for (char c : s) {
+		if (!(	(c >= '0' && c <= '9') ||
+			(c >= 'A' && c <= 'Z')
+		     ))
+			return false;
+	}
+	return true;
+}
+
+
+/** Beskrivning:  Tar in sträng där felaktiga tecken och delar av strängen filtreras bort och eventuellt sparas i en annan sträng ifall något finns kvar efter filtreringen
+* Argument 1:   std::string - sträng att filtrera på
+* Argument 2:	  std::string& - referens till sträng där den nya strängen eventuellt sparas
+* Return:       void
+* Exempel:
+*               parse_answer("YAH088", str) => str = "YAH088"
+*               parse_answer("YAH0#8", str) => str = ""
+*               parse_answer("YAH 088", str) => str = "YAH088"
+*               parse_answer("YAH088 |", str) => str = "YAH088"
+*               parse_answer("| YAH088 |", str) => str = "YAH088"
+*               parse_answer("| YAH 088 |b", str) => str = "YAH088"
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+void parse_answer(std::string answer, std::string &answer_parsed) {
+	std::vector<std::string> answer_arr = _split(answer, " ", true);
+
+	/* Sometimes the plate is devided into two parts by a blank space, remove it */
+	for (int i = 0; i < answer_arr.size(); i++) {
+		answer_arr[i].erase(std::remove(answer_arr[i].begin(), answer_arr[i].end(), ' '), answer_arr[i].end()); //remove A from string
+	}
+
+	/* In case result has new lines, remove them */
+	for (int i = 0; i < answer_arr.size(); i++) {
+		answer_arr[i].erase(std::remove(answer_arr[i].begin(), answer_arr[i].end(), '\n'), answer_arr[i].end()); //remove A from string
+	}
+
+	/* Remove element that doesn't have three characters */
+	answer_arr.erase(std::remove_if(answer_arr.begin(), answer_arr.end(), [](std::string &s) {
+				if (valid_chars(s))
+					return s.length() != 3 && s.length() != 6; // Sometimes the plate is devided into numbers and letters, sometimes they end up together
+				else
+					return true;
+		}), answer_arr.end()
+	);
+
+	/* Assembly */
+	for (const std::string &s : answer_arr)
+		answer_parsed += s;
+
+	/* Validate final answer */
+	if (answer_parsed.length() != 6)
+		answer_parsed = ""; // Failsafe: if answer isn't valid, we shall not use it
+}
+
+/** Beskrivning:  Tar in kandidater för en bild och klipper ut rutor som innehåller kandidaterna, dessa rutor skickas till tesseract api genom run_ocr() och spottar ut
+*									eventuellt funna registreringsskyltar efter att ha matchat dessa mot en lista av godkänt parkerade bilar
+* Argument 1:   OcrPool& - referens till poolen av Tesseract motorer, kandidaterna körs parallellt
+* Argument 2:	  cv::Mat& - referens bild att klippa ur kandidaterna från
+* Argument 3:	  std::vector<std::vector<cv::Point>>& - referens till eventuella kandidater för eventuella registreringsskyltar
+* Argument 4:   KnownCars& - index över känt parkerade bilar
+* Argument 5:   PlateTracker* - pekare till spårning mellan bildrutor, eller NULL för att köra ocr på varje kandidat utan röstning
+* Argument 6:   DebugFrame* - pekare till bildrutans debug bilder där utklippen sparas, eller NULL
+* Return:       std::vector<struct Match> - en vector av strukturen Match: eventuella matchningar
+* Exempel:
+*               std::vector<Match> matches = extract_ids(ocr, image, candidates, known_cars, NULL, NULL) => vector över strukturen Match, en för varje eventuell registreringsskylt
+*							  																																								samt dess status, ifall den är godkänd eller inte
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+std::vector<struct Match> extract_ids(OcrPool &ocr, cv::Mat &frame, std::vector<std::vector<cv::Point>> &candidates, KnownCars &known_cars, PlateTracker *tracker, DebugFrame *debug) {
+	ScopedTimer timer(METRICS.extract_ids);
+	METRICS.candidates_found.add(candidates.size());
+
+	// Convert to rectangles, locate_contours() has already left out the ones that are not plate shaped
+	std::vector<cv::Rect> rectangles;
+	rectangles.reserve(candidates.size());
+	for (const std::vector<cv::Point> &currentCandidate : candidates)
+		rectangles.push_back(cv::boundingRect(currentCandidate));
+
+	// Link the candidates to tracks from earlier frames, stable tracks only need OCR now and then
+	std::vector<int> track_ids;
+	if (tracker != NULL)
+		tracker->update(rectangles, track_ids);
+
+	// Collect every candidate first so they can be recognised in parallel, the crops are only kept for the debug images
+	std::vector<cv::Mat> crops;
+	std::vector<cv::Rect> ocr_rects;
+	crops.reserve(rectangles.size());
+	ocr_rects.reserve(rectangles.size());
+	std::vector<size_t> ocr_index(rectangles.size(), SIZE_MAX);
+	for (size_t i = 0; i < rectangles.size(); i++) {
+		cv::Rect rect = rectangles[i] & cv::Rect(0, 0, frame.cols, frame.rows); // Points scaled back from the processing size may round past the edge
+		crops.push_back(frame(rect));
+		if (tracker == NULL || tracker->needsOcr(track_ids[i])) {
+			ocr_index[i] = ocr_rects.size();
+			ocr_rects.push_back(rect);
+		}
+	}
+	std::vector<std::string> answers;
+	ocr.recognize(frame, ocr_rects, answers, debug);
+
+	std::string answer_parsed;
+	std::vector<struct Match> matches;
+	matches.reserve(rectangles.size());
+	for (size_t i = 0; i < rectangles.size(); i++) {
+		cv::Rect rect = rectangles[i];
+		struct Match match;
+		answer_parsed = "";
+		if (ocr_index[i] != SIZE_MAX)
+			parse_answer(answers[ocr_index[i]], answer_parsed);
+		if (tracker != NULL) {
+			// The plate is whatever the track has voted for so far
+			if (ocr_index[i] != SIZE_MAX)
+				answer_parsed = tracker->vote(track_ids[i], answer_parsed);
+			else
+				answer_parsed = tracker->consensus(track_ids[i]);
+		}
+
+		match.rectangle = rect;
+		match.id = answer_parsed;
+		match.id_valid = answer_parsed.length() > 1;
+		match.parking_valid = known_cars.contains(answer_parsed);
+		matches.push_back(match);
+		if (match.id_valid)
+			METRICS.valid_reads.add();
+		if (match.parking_valid)
+			METRICS.parking_valid.add();
+
+		debug_img(debug, "crop", crops[i]);
+	}
+	return matches;
+}
+
+
+/** Beskrivning:  Tar in en bild där eventuella matchningar ritas ut i form av rutor kring kandidater till registreringsskyltar, tillsammans med funnen text ifall där är någon,
+*									samt ifall den finns med i listan för godkänt parkerade skyltar. En bild i gråskala görs om till färg först, så att
+*									bildrutor som lästs med luma bara färgkonverteras när de visas eller skrivs ut
+* Argument 1:   cv::Mat& - referens till bild där eventuella matchningar ritas, kan bytas mot en kopia i färg
+* Argument 2:	  const std::vector<Match>& - referens till vector över strukturen Match, en lista över eventuella matchningar
+* Argument 3:	  const std::vector<std::vector<cv::Point>>& - referens för eventuella kandidater för eventuella registreringsskyltar
+* Return:       void
+* Exempel:
+*               drawMatches(image, matches, candidates); => rutor och text ritas, ifall matchningar finns, på bilden
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+void drawMatches(cv::Mat &frame, const std::vector<Match> &matches, const std::vector<std::vector<cv::Point>> &candidates) {
+	if (frame.channels() == 1)
+		cv::cvtColor(frame, frame, cv::COLOR_GRAY2BGR);
+	const int text_offset = 30 * frame.rows / 512; // The label sits as high above the bottom edge as it did on the 512x512 frame
+
+	// Draw the bounding box of the possible numberplate
+	for (const Match &match : matches) {
+		cv::Scalar color;
+		if (match.parking_valid) {
+			color = cv::Scalar(0, 255, 0); // Blue Green Red, BGR
+		} else if (match.id_valid) {
+			color = cv::Scalar(0, 0, 255);
+		} else {
+			color = cv::Scalar(255, 255, 255);
+		}
+		cv::rectangle(
+				frame,
+				match.rectangle.tl(),
+				match.rectangle.br(),
+				color,
+				3,
+				cv::LINE_8,
+				0
+			);
+		cv::putText(
+				frame,
+				match.id,
+				cv::Point(match.rectangle.x, match.rectangle.y + match.rectangle.height - text_offset),
+				cv::FONT_HERSHEY_DUPLEX,
+				1.0f,
+				color,
+				2
+			);
+		if (match.id_valid && match.parking_valid) {
+			cv::putText(
+					frame,
+					"OK " + match.id,
+					cv::Point(match.rectangle.x, match.rectangle.y + match.rectangle.height),
+					cv::FONT_HERSHEY_DUPLEX,
+					1.0f,
+					color,
+					2
+				);
+		}
+	}
+
+	// Print circles
+	int i = 0;
+	for (const std::vector<cv::Point> &currentCandidate : candidates) {
+		for (const cv::Point &p : currentCandidate) {
+			cv::Scalar color = cv::Scalar(0, (25*i)&255, (255-25*i)&255);
+			cv::circle(frame, p, 4, color);
+		}
+		i++;
+	}
+}
+
+/** Beskrivning:  Tar in text och bild för att sedan, ifall bildrutan sparas, lämna en kopia av bilden till skrivartråden i DebugImages som sparar den
+*									i debug katalogen med filnamnet startat på ett nummer följt av argument 2 och filtypen
+* Argument 1:   DebugFrame* - pekare till bildrutans debug bilder, eller NULL när bildrutan inte ska sparas
+* Argument 2:   const char* - pekare till constant char, den pekar på en sträng i minnet som sedan tar del i namnet för den sparade filen
+* Argument 3:	  cv::Mat& - referens till den bild att spara
+* Return:       void
+* Exempel:
+*               debug_img(ctx.debug, "GaussianBlur", image); => fil sparas med namnet "1-GaussianBlur.jpg" och innehållet av bilden "image"
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+void debug_img(DebugFrame *debug, const char* name, cv::Mat &img) {
+	if (debug != NULL)
+		debug->add(name, img);
+}
+
+/** Beskrivning:  Tar in en bild och utför en serie av algoritmer för att peka ut kandidater för eventuella registreringsskyltar. Dessa retuneras sedan.
+*									Varje steg ligger i en egen funktion (locate_resize, locate_morphology, locate_sobel, locate_threshold, locate_contours)
+*									så att de kan mätas var för sig. Utan debugbilder körs morphology, sobel och threshold som ett parallellt steg,
+*									locate_front_end. Alla mellanresultat sparas i kontexten och återanvänds mellan bildrutor
+* Argument 1:   cv::Mat& - referens till bild där eventuella kandidater skall hittas
+* Argument 2:   DetectionContext& - referens till arbetsytan för strömmen, processing_width och keep styr upplösning och antal kandidater
+* Return:       std::vector<std::vector<cv::Point>>& - referens till kontextens kandidater i bildens pixlar, gäller tills nästa anrop med samma kontext
+* Exempel:
+*               candidates = locateCandidates(image, detection); => returnerar en vector av eventuella registreringsskyltar, varje skylt representerar en egen vector av punkter (kandidater)
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+std::vector<std::vector<cv::Point>>& locateCandidates(cv::Mat &frame, DetectionContext &ctx) {
+	return locateCandidatesInRegion(frame, cv::Rect(0, 0, frame.cols, frame.rows), ctx);
+}
+
+/** Beskrivning:  Första steget i locateCandidates(), skalar ner bilden med bevarat bildförhållande och gör den till gråskala.
+*									Skalan är ctx.scale, satt av setFrameSize() så att en del av bilden får samma skala som hela bilden
+* Argument 1:   cv::Mat& - referens till bilden, eller den del av bilden som ska sökas igenom, i full upplösning
+* Argument 2:   DetectionContext& - referens till arbetsytan, gråskalebilden sparas i processedFrame
+* Return:       void
+* Exempel:
+*               locate_resize(frame, detection) => detection.processedFrame är 512x288 med en kanal för en bild i 1280x720
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void locate_resize(cv::Mat &frame, DetectionContext &ctx) {
+	// Reduce the image dimension to process
+	cv::Size size(std::max(1, cvRound(frame.cols * ctx.scale)), std::max(1, cvRound(frame.rows * ctx.scale)));
+
+	// Must be converted to grayscale, kept in separate images since an in-place conversion reallocates
+	if (frame.channels() == 3) {
+		cv::resize(frame, ctx.resizedFrame, size);
+		debug_img(ctx.debug, "start", ctx.resizedFrame);
+		cv::cvtColor(ctx.resizedFrame, ctx.processedFrame, cv::COLOR_BGR2GRAY);
+	} else {
+		cv::resize(frame, ctx.processedFrame, size);
+		debug_img(ctx.debug, "start", ctx.processedFrame);
+	}
+
+	debug_img(ctx.debug, "grayscale", ctx.processedFrame);
+}
+
+/** Beskrivning:  Andra steget i locateCandidates(), morfologiska operationer: open som tar bort öar, blackhat som tar fram mörka
+*									regioner på ljus bakgrund och close följt av Otsu för att hitta ljusa regioner. Operationerna är uppdelade i
+*									erode och dilate med ett mellanresultat i kontexten, eftersom morphologyEx skapar en ny temporär bild varje gång
+* Argument 1:   DetectionContext& - referens till arbetsytan, öarna tas bort direkt i processedFrame och resultaten sparas i blackhatFrame och lightFrame
+* Return:       void
+* Exempel:
+*               locate_morphology(detection)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void locate_morphology(DetectionContext &ctx) {
+	// Remove islands, especially the eu country character such as "s" for sweden or "hr" for croatia. Otherwise this will mess with the rectangle
+	cv::erode(ctx.processedFrame, ctx.morphFrame, ctx.largerKernel);
+	cv::dilate(ctx.morphFrame, ctx.processedFrame, ctx.largerKernel);
+
+	debug_img(ctx.debug, "removed_island", ctx.processedFrame);
+
+	// Perform blackhat morphological operation, reveal dark regions on light backgrounds. Shapes are set 13 pixels wide by 5 pixels tall
+	cv::dilate(ctx.processedFrame, ctx.morphFrame, ctx.rectangleKernel);
+	cv::erode(ctx.morphFrame, ctx.blackhatFrame, ctx.rectangleKernel);
+	cv::subtract(ctx.blackhatFrame, ctx.processedFrame, ctx.blackhatFrame);
+
+	debug_img(ctx.debug, "morphological_opt", ctx.blackhatFrame);
+
+	// Find license plate based on whiteness property
+	cv::dilate(ctx.processedFrame, ctx.morphFrame, ctx.squareKernel);
+	cv::erode(ctx.morphFrame, ctx.lightFrame, ctx.squareKernel);
+	cv::threshold(ctx.lightFrame, ctx.lightFrame, 0, 255, cv::THRESH_OTSU);
+
+	debug_img(ctx.debug, "white_regions", ctx.lightFrame);
+}
+
+/** Beskrivning:  Tredje steget i locateCandidates(), horisontell Sobel gradient av blackhat resultatet normaliserad till [0, 255].
+*									Gradient, absolutbelopp, max och normalisering görs av fused_scharr_x() med SSE4.1 eller AVX2 när processorn har det
+* Argument 1:   DetectionContext& - referens till arbetsytan, gradienten sparas i gradX som en kanal med 8 bitar
+* Return:       void
+* Exempel:
+*               locate_sobel(detection)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void locate_sobel(DetectionContext &ctx) {
+	// Same result as cv::Sobel to CV_32F with ksize -1, abs, minMaxLoc and 255 * ((gradX - minVal) / (maxVal - minVal)) to CV_8U
+	cv::Mat &blackhat = ctx.blackhatFrame;
+	ctx.gradMagnitude.create(blackhat.rows, blackhat.cols, CV_16U);
+	ctx.gradX.create(blackhat.rows, blackhat.cols, CV_8U);
+	fused_scharr_x(blackhat.data, blackhat.step, ctx.gradX.data, ctx.gradX.step, (uint16_t*) ctx.gradMagnitude.data, blackhat.rows, blackhat.cols);
+
+	debug_img(ctx.debug, "sobel", ctx.gradX);
+}
+
+/** Beskrivning:  Fjärde steget i locateCandidates(), blur, close och Otsu tröskling av gradienten följt av erode och dilate
+* Argument 1:   DetectionContext& - referens till arbetsytan, den binära bilden sparas i gradX
+* Return:       void
+* Exempel:
+*               locate_threshold(detection) => detection.gradX är en binär bild
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void locate_threshold(DetectionContext &ctx) {
+	// Blur the gradient result, and apply closing operation
+	cv::GaussianBlur(ctx.gradX, ctx.blurFrame, cv::Size(5,5), 0);
+	debug_img(ctx.debug, "blur", ctx.blurFrame);
+	cv::dilate(ctx.blurFrame, ctx.morphFrame, ctx.rectangleKernel);
+	cv::erode(ctx.morphFrame, ctx.gradX, ctx.rectangleKernel);
+	debug_img(ctx.debug, "morph", ctx.gradX);
+	cv::threshold(ctx.gradX, ctx.gradX, 0, 255, cv::THRESH_OTSU);
+
+	debug_img(ctx.debug, "thres", ctx.gradX);
+
+	// Erode and dilate
+	cv::erode(ctx.gradX, ctx.gradX, 2);
+	cv::dilate(ctx.gradX, ctx.gradX, 2);
+
+	debug_img(ctx.debug, "erode_dilate", ctx.gradX);
+
+	// Bitwise AND between threshold result and light regions
+	cv::bitwise_and(ctx.gradX, ctx.gradX, ctx.lightFrame);
+	cv::dilate(ctx.gradX, ctx.gradX, 2);
+	cv::erode(ctx.gradX, ctx.gradX, 1);
+
+	debug_img(ctx.debug, "bitwise_AND", ctx.gradX);
+}
+
+/** Beskrivning:  locate_morphology(), locate_sobel() och locate_threshold() i ett steg. Bilden delas i horisontella band som körs parallellt
+*									med cv::parallel_for_, och varje band kedjar open, blackhat, gradient, blur och close med de extra rader kärnorna
+*									når, så att bandets rader är kvar i cachen mellan stegen. Erode och dilate är separerade med van Herk och
+*									Gil-Werman och SSE2. Gradientens max och Otsus histogram behöver hela bilden, så bandens max och histogram slås
+*									ihop mellan de två faserna. Resultatet är exakt samma som stegen var för sig. lightFrame fylls inte, resultatet
+*									av bitwise_and i locate_threshold() skrivs över utan att läsas, och erode och dilate med kärnan 1 eller 2 där
+*									ändrar ingenting
+* Argument 1:   DetectionContext& - referens till arbetsytan med gråskalebilden i processedFrame, samma bilder sätts som av stegen
+* Return:       void
+* Exempel:
+*               locate_front_end(detection) => detection.gradX är samma binära bild som efter locate_threshold(detection)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void locate_front_end(DetectionContext &ctx) {
+	int rows = ctx.processedFrame.rows;
+	int cols = ctx.processedFrame.cols;
+	ctx.morphFrame.create(rows, cols, CV_8U);
+	ctx.blackhatFrame.create(rows, cols, CV_8U);
+	ctx.gradMagnitude.create(rows, cols, CV_16U);
+	ctx.blurFrame.create(rows, cols, CV_8U);
+	ctx.gradX.create(rows, cols, CV_8U);
+	FrontEndFrame frame = { ctx.processedFrame.data, ctx.processedFrame.step, ctx.morphFrame.data, ctx.morphFrame.step, ctx.blackhatFrame.data,
+		ctx.blackhatFrame.step, (uint16_t*) ctx.gradMagnitude.data, ctx.blurFrame.data, ctx.blurFrame.step, ctx.gradX.data, ctx.gradX.step, rows, cols };
+
+	// Every band recomputes up to 13 rows above and below itself, so a band is kept a good deal taller than that
+	int bands = ctx.bands > 0 ? std::min(ctx.bands, std::max(1, rows / 4)) : std::max(1, std::min(cv::getNumThreads(), rows / FRONT_END_MIN_ROWS));
+	ctx.front_end.resize(bands);
+	for (int b = 0; b < bands; b++) {
+		ctx.front_end[b].first = rows * b / bands;
+		ctx.front_end[b].last = rows * (b + 1) / bands;
+	}
+
+	cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+		for (int b = range.start; b < range.end; b++)
+			front_end_gradient(frame, ctx.front_end[b]);
+	}, bands);
+	uint16_t max_gradient = 0;
+	for (int b = 0; b < bands; b++)
+		max_gradient = std::max(max_gradient, ctx.front_end[b].max_gradient);
+	uint8_t table[SCHARR_X_MAX + 1];
+	scharr_x_table(max_gradient, table);
+
+	cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+		for (int b = range.start; b < range.end; b++)
+			front_end_close(frame, table, ctx.front_end[b]);
+	}, bands);
+	uint32_t histogram[256] = {};
+	for (int b = 0; b < bands; b++)
+		for (int i = 0; i < 256; i++)
+			histogram[i] += ctx.front_end[b].histogram[i];
+	cv::threshold(ctx.gradX, ctx.gradX, front_end_otsu(histogram, (long) rows * cols), 255, cv::THRESH_BINARY);
+
+	// The opened gray is in processedFrame after the stages
+	std::swap(ctx.processedFrame, ctx.morphFrame);
+}
+
+/** Beskrivning:  Sista steget i locateCandidates(), hittar konturer i den binära bilden och rangordnar dem. Area, rektangel, bildförhållande och
+*									kantätthet räknas en gång per kontur, och former som aldrig kan vara en skylt enligt RECT_DIFF, MIN_AR och MAX_AR
+*									sorteras bort innan de tar en plats. Av de andra behålls de ctx.keep med högst poäng, area gånger fyllnadsgrad
+*									gånger medelgradienten i rektangeln, med partiell sortering. Finns det färre än ctx.keep behålls alla
+* Argument 1:   DetectionContext& - referens till arbetsytan med den binära bilden i gradX och den suddiga gradienten i blurFrame
+* Return:       std::vector<std::vector<cv::Point>>& - referens till kandidaterna i den nerskalade bildens koordinater, högst poäng först
+* Exempel:
+*               locate_contours(detection) => de fem mest skyltlika konturerna när keep är fem, eller färre ifall bara färre ser ut som skyltar
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::vector<std::vector<cv::Point>>& locate_contours(DetectionContext &ctx) {
+	cv::findContours(ctx.gradX, ctx.contours, cv::noArray(), cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+	size_t count = ctx.contours.size();
+	ctx.scores.resize(count);
+	ctx.order.clear();
+	for (size_t i = 0; i < count; i++) {
+		const std::vector<cv::Point> &contour = ctx.contours[i];
+		cv::Rect box = cv::boundingRect(contour);
+		double area = fabs(cv::contourArea(contour));
+
+		// The same filters as extract_ids(), applied before the contour can take a slot from a plausible one
+		if ((box.area() - area) * ctx.area_scale >= RECT_DIFF) {
+			METRICS.candidates_rejected_rect.add();
+			continue;
+		}
+		const double aspect_ratio = box.width / (double) box.height;
+		if (aspect_ratio < MIN_AR || aspect_ratio > MAX_AR) {
+			METRICS.candidates_rejected_aspect.add();
+			continue;
+		}
+
+		// Large, well filled boxes with dense vertical edges, as the characters of a plate give, rank first
+		double fill = area / box.area();
+		double edge_density = cv::mean(ctx.blurFrame(box))[0] / 255.0;
+		ctx.scores[i] = area * fill * edge_density;
+		ctx.order.push_back(i);
+	}
+
+	size_t keep = std::min(ctx.order.size(), (size_t) std::max(1, ctx.keep));
+	std::partial_sort(ctx.order.begin(), ctx.order.begin() + keep, ctx.order.end(), [&ctx](size_t a, size_t b) { return ctx.scores[a] > ctx.scores[b]; });
+	ctx.candidates.resize(keep);
+	for (size_t i = 0; i < keep; i++) {
+		const std::vector<cv::Point> &contour = ctx.contours[ctx.order[i]];
+		ctx.candidates[i].assign(contour.begin(), contour.end());
+	}
+
+	return ctx.candidates;
+}
+
+/** Beskrivning:  Kör stegen i locateCandidates() på en del av bilden och räknar om kandidaternas punkter till pixlar i hela bilden.
+*									Delen skalas med samma skala som hela bilden skulle ha fått, så att strukturelementen motsvarar lika stora områden
+* Argument 1:   cv::Mat& - referens till bilden i full upplösning
+* Argument 2:   cv::Rect - den del av bilden som ska sökas igenom
+* Argument 3:   DetectionContext& - referens till arbetsytan för strömmen
+* Return:       std::vector<std::vector<cv::Point>>& - referens till kontextens kandidater i bildens pixlar
+* Exempel:
+*               locateCandidatesInRegion(frame, cv::Rect(0, 0, frame.cols, frame.rows), detection) => samma som locateCandidates(frame, detection)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::vector<std::vector<cv::Point>>& locateCandidatesInRegion(cv::Mat &frame, cv::Rect roi, DetectionContext &ctx) {
+	ScopedTimer timer(METRICS.locate);
+	ctx.setFrameSize(frame.size());
+	cv::Mat region = frame(roi);
+	locate_resize(region, ctx);
+	if (ctx.debug == NULL) {
+		locate_front_end(ctx);
+	} else {
+		// The stages one by one save the images between them
+		locate_morphology(ctx);
+		locate_sobel(ctx);
+		locate_threshold(ctx);
+	}
+	std::vector<std::vector<cv::Point>> &candidates = locate_contours(ctx);
+
+	// From the processing size of the region to pixels in the frame
+	double scale_x = roi.width / (double) ctx.processedFrame.cols;
+	double scale_y = roi.height / (double) ctx.processedFrame.rows;
+	for (std::vector<cv::Point> &candidate : candidates) {
+		for (cv::Point &p : candidate) {
+			p.x = cvRound(p.x * scale_x) + roi.x;
+			p.y = cvRound(p.y * scale_y) + roi.y;
+		}
+	}
+	return candidates;
+}
+
+/** Beskrivning:  Funktionen tar in en sträng, klipper upp denna strängen vid specifka matchningar, och filtrerar bort eventuella specifka dubbel matchningar
+* Argument 1:   std::string - sträng att dela upp
+* Argument 2:   std::string - specifika matchningen att klippa strängen vid
+* Return:       std::vector<std::string> - vector av strängar
+* Exempel:
+*               _split("hej där  victor!", " ", true) = ["hej", "där", "victor!"]
+*               _split("hej där  victor!", " ", false) = ["hej", "där", "", "victor!"]
+*
+* By:           Vigor Turujlija Gamelius
+* Date:         2022-06-03
+**/
+std::vector<std::string> _split(std::string s, std::string delimiter, bool avoid_double){
+	std::vector<std::string> output;
+
+	size_t pos = 0;
+	std::string token;
+	while ((pos = s.find(delimiter)) != std::string::npos) {
+		/* If pos is 0 we have a double delimiter and something is probably wrong */
+		if (pos == 0 && avoid_double) {
+			s.erase(0, 1);
+			continue;
+		}
+		token = s.substr(0, pos);
+		output.push_back(token);
+		s.erase(0, pos + delimiter.length());
+	}
+	// add the rest of the string to last element
+	output.push_back(s);
+	return output;
+}
+
+/** Beskrivning:  Kontrollerar ifall ett argument börjar med en flagga på formen "--namn=" och returnerar i så fall värdet efter likhetstecknet
+* Argument 1:   const char* - argumentet från kommandotolken
+* Argument 2:   const char* - flaggan inklusive likhetstecken
+* Return:       const char* - pekare till värdet, eller NULL ifall argumentet inte är flaggan
+* Exempel:
+*               flag_value("--queue=8", "--queue=") => "8"
+*               flag_value("--debug", "--queue=") => NULL
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+const char* flag_value(const char *arg, const char *flag) {
+	size_t length = strlen(flag);
+	if (strncmp(arg, flag, length) == 0)
+		return arg + length;
+	return NULL;
+}
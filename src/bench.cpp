@@ -0,0 +1,349 @@
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "detection_context.hpp"
+#include "gradient.hpp"
+#include "known_cars.hpp"
+#include "metrics.hpp"
+#include "ocr_pool.hpp"
+#include "plate_classifier.hpp"
+
+struct {
+	int warmup = 3;
+	int reps = 30;
+	bool csv = false;
+	std::string known_cars = "";
+	std::string language = "swe";
+	bool ocr = true;
+	int width = PROCESSING_WIDTH;
+	int bands = 0;
+	std::string ocr_model = "";
+	bool luma = false;
+} BENCH_FLAGS;
+
+// Measurements of one stage on one image
+struct StageResult {
+	std::string image;
+	std::string stage;
+	std::vector<double> samples; // Microseconds per run
+	double allocations = 0; // Heap allocations over all measured runs
+};
+
+// Every heap allocation in the process, OpenCV allocates through posix_memalign and C++ through malloc
+std::atomic<unsigned long long> heap_allocations(0);
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(pointer, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	*pointer = __libc_memalign(alignment, size);
+	return *pointer == NULL ? ENOMEM : 0;
+}
+}
+#endif
+
+/** Beskrivning:  Skriver ut median, p95 och p99 för ett steg som en JSON rad eller CSV rad
+* Argument 1:   StageResult& - referens till mätningarna
+* Return:       void
+* Exempel:
+*               print_result(result) => {"image":"samples/001.jpg","stage":"sobel","runs":30,"mean_us":812.4,"median_us":790.1,"p95_us":901.3,"p99_us":950.0,"allocs_per_run":0.0}
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void print_result(StageResult &result) {
+	if (result.samples.empty())
+		return;
+	std::vector<double> sorted = result.samples;
+	std::sort(sorted.begin(), sorted.end());
+	double mean = 0;
+	for (double sample : sorted)
+		mean += sample;
+	mean /= sorted.size();
+	double allocations = result.allocations / sorted.size();
+
+	if (BENCH_FLAGS.csv) {
+		printf("%s,%s,%zu,%.2f,%.2f,%.2f,%.2f,%.1f\n", result.image.c_str(), result.stage.c_str(), sorted.size(),
+			mean, percentile(sorted, 50), percentile(sorted, 95), percentile(sorted, 99), allocations);
+	} else {
+		printf("{\"image\":\"%s\",\"stage\":\"%s\",\"runs\":%zu,\"mean_us\":%.2f,\"median_us\":%.2f,\"p95_us\":%.2f,\"p99_us\":%.2f,\"allocs_per_run\":%.1f}\n",
+			result.image.c_str(), result.stage.c_str(), sorted.size(),
+			mean, percentile(sorted, 50), percentile(sorted, 95), percentile(sorted, 99), allocations);
+	}
+	fflush(stdout);
+}
+
+/** Beskrivning:  Mäter ett steg BENCH_FLAGS.reps gånger efter BENCH_FLAGS.warmup omätta körningar. prepare körs före varje körning
+*									utan att räknas, för steg som skriver över sin indata. Heap allokeringar under de mätta körningarna räknas också
+* Argument 1:   StageResult& - referens där mätningarna läggs till
+* Argument 2:   std::function<void()> - förberedelse, mäts inte
+* Argument 3:   std::function<void()> - steget som mäts
+* Return:       void
+* Exempel:
+*               time_stage(result, [&]{ saved.copyTo(detection.processedFrame); }, [&]{ locate_morphology(detection); })
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void time_stage(StageResult &result, std::function<void()> prepare, std::function<void()> run) {
+	for (int i = 0; i < BENCH_FLAGS.warmup + BENCH_FLAGS.reps; i++) {
+		prepare();
+		unsigned long long allocations = heap_allocations.load(std::memory_order_relaxed);
+		auto start = std::chrono::steady_clock::now();
+		run();
+		auto end = std::chrono::steady_clock::now();
+		allocations = heap_allocations.load(std::memory_order_relaxed) - allocations;
+		if (i >= BENCH_FLAGS.warmup) {
+			result.samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+			result.allocations += allocations;
+		}
+	}
+}
+
+/** Beskrivning:  Letar upp alla bilder i de kataloger och filer som angetts, i sorterad ordning så att körningar går att jämföra
+* Argument 1:   std::vector<std::string>& - referens till kataloger eller filer
+* Return:       std::vector<std::string> - sökvägar till alla jpg och png bilder
+* Exempel:
+*               collect_images({"../samples", "../demo"}) => ["../samples/001.jpg", ..., "../demo/7.jpg"]
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::vector<std::string> collect_images(std::vector<std::string> &inputs) {
+	std::vector<std::string> images;
+	for (std::string &input : inputs) {
+		std::vector<std::string> found;
+		if (std::filesystem::is_directory(input)) {
+			for (const auto &entry : std::filesystem::directory_iterator(input)) {
+				std::string extension = entry.path().extension().string();
+				if (extension == ".jpg" || extension == ".jpeg" || extension == ".png")
+					found.push_back(entry.path().string());
+			}
+			std::sort(found.begin(), found.end());
+		} else {
+			found.push_back(input);
+		}
+		images.insert(images.end(), found.begin(), found.end());
+	}
+	return images;
+}
+
+/** Beskrivning:  Mikrobenchmark för varje steg i detekteringen och ocr, körs över alla bilder i de angivna katalogerna.
+*									Resultatet skrivs som en JSON rad (eller CSV rad) per bild och steg, samt en rad per steg över alla bilder med image "*"
+* Argument 1:   int - antal argument
+* Argument 2:   char** - kataloger eller bilder, samt valfria flaggor: --warmup=N, --reps=N, --format=json|csv,
+*												 --known-cars=fil, --lang=språk, --no-ocr, --width=N, --bands=N, --ocr-model=fil, --luma
+* Return:       int - status kod för programmet
+* Exempel:
+*               ./anpr_bench ../samples ../demo --reps=50 > bench.jsonl
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int main(int argc, char** argv) {
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; i++) {
+		const char *value;
+		if ((value = flag_value(argv[i], "--warmup="))) {
+			BENCH_FLAGS.warmup = std::max(0, atoi(value));
+		} else if ((value = flag_value(argv[i], "--reps="))) {
+			BENCH_FLAGS.reps = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--format="))) {
+			BENCH_FLAGS.csv = strcmp(value, "csv") == 0;
+		} else if ((value = flag_value(argv[i], "--known-cars="))) {
+			BENCH_FLAGS.known_cars = value;
+		} else if ((value = flag_value(argv[i], "--lang="))) {
+			BENCH_FLAGS.language = value;
+		} else if ((value = flag_value(argv[i], "--width="))) {
+			BENCH_FLAGS.width = std::max(32, atoi(value));
+		} else if ((value = flag_value(argv[i], "--bands="))) {
+			BENCH_FLAGS.bands = std::max(0, atoi(value));
+		} else if ((value = flag_value(argv[i], "--ocr-model="))) {
+			BENCH_FLAGS.ocr_model = value;
+		} else if (strcmp(argv[i], "--no-ocr") == 0) {
+			BENCH_FLAGS.ocr = false;
+		} else if (strcmp(argv[i], "--luma") == 0) {
+			BENCH_FLAGS.luma = true;
+		} else {
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (inputs.empty()) {
+		std::cerr << "Please pass directories or images to benchmark" << std::endl;
+		return 1;
+	}
+	std::vector<std::string> images = collect_images(inputs);
+	std::cerr << "Gradient kernel: " << fused_scharr_x_kernel() << std::endl;
+
+	tesseract::TessBaseAPI *api = NULL;
+	if (BENCH_FLAGS.ocr) {
+		api = new tesseract::TessBaseAPI();
+		if (api->Init(NULL, BENCH_FLAGS.language.c_str())) {
+			fprintf(stderr, "Could not initialize tesseract.\n");
+			return 1;
+		}
+	}
+	KnownCars *known_cars = BENCH_FLAGS.known_cars.empty() ? NULL : new KnownCars(BENCH_FLAGS.known_cars.c_str());
+	PlateClassifier *classifier = NULL;
+	if (!BENCH_FLAGS.ocr_model.empty()) {
+		classifier = new PlateClassifier();
+		if (!classifier->load(BENCH_FLAGS.ocr_model)) {
+			std::cerr << "Cannot load ocr model " << BENCH_FLAGS.ocr_model << std::endl;
+			return 1;
+		}
+	}
+
+	const char *stages[] = { "resize", "morphology", "sobel", "threshold", "contours", "locate_total", "run_ocr", "parse_answer", "known_cars_lookup", "sobel_opencv", "ocr_fast", "ocr_frame", "ocr_montage", "front_end" };
+	const size_t stage_count = sizeof(stages) / sizeof(stages[0]);
+	std::vector<StageResult> totals(stage_count);
+	for (size_t s = 0; s < stage_count; s++) {
+		totals[s].image = "*";
+		totals[s].stage = stages[s];
+	}
+	if (BENCH_FLAGS.csv)
+		printf("image,stage,runs,mean_us,median_us,p95_us,p99_us,allocs_per_run\n");
+
+	for (std::string &path : images) {
+		cv::Mat frame = cv::imread(path, BENCH_FLAGS.luma ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR); // JPEG decodes only the Y component in grayscale
+		if (frame.empty()) {
+			std::cerr << "Cannot read " << path << std::endl;
+			continue;
+		}
+		std::vector<StageResult> results(stage_count);
+		for (size_t s = 0; s < stage_count; s++) {
+			results[s].image = path;
+			results[s].stage = stages[s];
+		}
+
+		// Every stage gets the same input as it would inside locateCandidates, stages that overwrite their input get it restored before each run
+		DetectionContext detection;
+		detection.processing_width = BENCH_FLAGS.width;
+		detection.bands = BENCH_FLAGS.bands;
+		detection.setFrameSize(frame.size());
+		cv::Mat gray, gradX, light, binary, blur;
+		time_stage(results[0], [] {}, [&] { locate_resize(frame, detection); });
+		detection.processedFrame.copyTo(gray);
+		time_stage(results[1], [&] { gray.copyTo(detection.processedFrame); }, [&] { locate_morphology(detection); });
+		time_stage(results[2], [] {}, [&] { locate_sobel(detection); });
+		detection.gradX.copyTo(gradX);
+		detection.lightFrame.copyTo(light);
+
+		// The OpenCV passes the fused gradient replaced, it must give the exact same image
+		cv::Mat reference, reference_float;
+		time_stage(results[9], [] {}, [&] {
+			double minVal, maxVal;
+			cv::Sobel(detection.blackhatFrame, reference_float, CV_32F, 1, 0, -1);
+			reference_float = cv::abs(reference_float);
+			cv::minMaxLoc(reference_float, &minVal, &maxVal);
+			reference_float = 255 * ((reference_float - minVal) / (maxVal - minVal));
+			reference_float.convertTo(reference, CV_8U);
+		});
+		if (cv::norm(reference, gradX, cv::NORM_INF) > 0)
+			std::cerr << "Fused gradient differs from OpenCV by up to " << cv::norm(reference, gradX, cv::NORM_INF) << " on " << path << std::endl;
+		time_stage(results[3], [&] { gradX.copyTo(detection.gradX); light.copyTo(detection.lightFrame); }, [&] { locate_threshold(detection); });
+		detection.gradX.copyTo(binary);
+		detection.blurFrame.copyTo(blur);
+
+		// The banded front-end replaces morphology, sobel and threshold, it must give the exact same images
+		time_stage(results[13], [&] { gray.copyTo(detection.processedFrame); }, [&] { locate_front_end(detection); });
+		if (cv::norm(binary, detection.gradX, cv::NORM_INF) > 0 || cv::norm(blur, detection.blurFrame, cv::NORM_INF) > 0)
+			std::cerr << "Front-end differs from the stages on " << path << std::endl;
+		time_stage(results[4], [&] { binary.copyTo(detection.gradX); }, [&] { locate_contours(detection); });
+		time_stage(results[5], [] {}, [&] { locateCandidates(frame, detection); });
+		std::vector<std::vector<cv::Point>> candidates = detection.candidates;
+
+		// OCR on the bounding box of every candidate, the candidates are in frame pixels
+		std::vector<std::string> answers;
+		std::vector<cv::Rect> rects;
+		for (std::vector<cv::Point> &candidate : candidates) {
+			cv::Rect rect = cv::boundingRect(candidate) & cv::Rect(0, 0, frame.cols, frame.rows);
+			cv::Mat crop = frame(rect);
+			std::string answer;
+			rects.push_back(rect);
+			if (api != NULL)
+				time_stage(results[6], [&] { configure_ocr(api, OcrMode::CROP); }, [&] { run_ocr(api, crop, answer); });
+			if (classifier != NULL) {
+				std::string fast;
+				time_stage(results[10], [] {}, [&] { classifier->classify(crop, fast); });
+			}
+			answers.push_back(answer);
+		}
+
+		// The per frame modes read all candidates of the image in one call
+		if (api != NULL && !rects.empty()) {
+			std::vector<std::string> frame_answers;
+			time_stage(results[11], [&] { configure_ocr(api, OcrMode::FRAME); }, [&] { run_ocr_regions(api, frame, rects, frame_answers); });
+			time_stage(results[12], [&] { configure_ocr(api, OcrMode::MONTAGE); }, [&] { run_ocr_montage(api, frame, rects, frame_answers); });
+		}
+
+		std::string parsed;
+		for (std::string &answer : answers)
+			time_stage(results[7], [&] { parsed = ""; }, [&] { parse_answer(answer, parsed); });
+
+		if (known_cars != NULL) {
+			// Single lookups are too fast for the clock, time a batch and report per lookup
+			const int batch = 1000;
+			std::vector<std::string> plates = { "YAJ066", "FSK394", "ABC123", "" };
+			for (std::string &answer : answers) {
+				parsed = "";
+				parse_answer(answer, parsed);
+				plates.push_back(parsed);
+			}
+			volatile size_t found = 0; // Keeps the lookups from being optimised away
+			time_stage(results[8], [] {}, [&] {
+				for (int i = 0; i < batch; i++)
+					found = found + known_cars->contains(plates[i % plates.size()]);
+			});
+			for (double &sample : results[8].samples)
+				sample /= batch;
+			results[8].allocations /= batch;
+		}
+
+		for (size_t s = 0; s < stage_count; s++) {
+			print_result(results[s]);
+			totals[s].samples.insert(totals[s].samples.end(), results[s].samples.begin(), results[s].samples.end());
+			totals[s].allocations += results[s].allocations;
+		}
+	}
+	for (StageResult &total : totals)
+		print_result(total);
+
+	if (known_cars != NULL)
+		delete known_cars;
+	if (classifier != NULL)
+		delete classifier;
+	if (api != NULL) {
+		api->End();
+		delete api;
+	}
+	return 0;
+}
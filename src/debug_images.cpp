@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "debug_images.hpp"
+
+/** Beskrivning:  Kontrollerar ifall ett steg är valt i DebugConfig::stages, alla steg är valda när listan är tom
+* Argument 1:   const char* - namn på steget
+* Return:       bool - true ifall stegets bild ska sparas
+* Exempel:
+*               frame->wants("crop") => true med --debug-stages=crop,done
+*               frame->wants("sobel") => false med --debug-stages=crop,done
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool DebugFrame::wants(const char *name) const {
+	if (this->config.stages.empty())
+		return true;
+	for (const std::string &stage : this->config.stages) {
+		if (stage == name)
+			return true;
+	}
+	return false;
+}
+
+/** Beskrivning:  Ger nästa lediga buffert i bildrutan, mutex måste vara låst. Bufferten har kvar sitt minne från en tidigare bildruta
+* Argument 1:   const char* - namn på steget
+* Return:       cv::Mat& - referens till bufferten att kopiera bilden till
+* Exempel:
+*               image.copyTo(frame->slot("done"))
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+cv::Mat& DebugFrame::slot(const char *name) {
+	if (this->used == this->images.size())
+		this->images.emplace_back();
+	this->images[this->used].first = name;
+	return this->images[this->used++].second;
+}
+
+/** Beskrivning:  Kopierar en bild till bildrutan ifall steget är valt, bilden kan ändras direkt efteråt
+* Argument 1:   const char* - namn på steget, blir en del av filnamnet
+* Argument 2:   const cv::Mat& - referens till bilden
+* Return:       void
+* Exempel:
+*               frame->add("crop", crop) => "debug/12-0-crop.jpg" när bildrutan skrivs
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void DebugFrame::add(const char *name, const cv::Mat &img) {
+	if (!this->wants(name))
+		return;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	img.copyTo(this->slot(name));
+}
+
+/** Beskrivning:  Konstruktor som skapar katalogen och startar skrivartråden
+* Argument 1:   DebugConfig - katalog, format, steg och urval av bildrutor
+* Return:       DebugImages - DebugImages objekt
+* Exempel:
+*               DebugImages debug(config) => katalogen config.directory finns
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+DebugImages::DebugImages(DebugConfig config_in) {
+	this->config = config_in;
+	if (this->config.every < 1)
+		this->config.every = 1;
+	if (this->config.queue_size < 1)
+		this->config.queue_size = 1;
+
+	std::error_code error;
+	std::filesystem::create_directories(this->config.directory, error);
+	if (error)
+		std::cerr << "Cannot create " << this->config.directory << ": " << error.message() << std::endl;
+
+	switch (this->config.format) {
+	case DebugFormat::JPEG:
+		this->extension = ".jpg";
+		break;
+	case DebugFormat::PNG:
+		this->extension = ".png";
+		this->params = {cv::IMWRITE_PNG_COMPRESSION, 1};
+		break;
+	case DebugFormat::RAW:
+		this->extension = ".pgm"; // .ppm for colour images
+		this->params = {cv::IMWRITE_PXM_BINARY, 1};
+		break;
+	}
+	this->writer = std::thread(&DebugImages::write, this);
+}
+
+/** Beskrivning:  Destruktor som skriver de bildrutor som redan står i kön och sedan stoppar skrivartråden
+* Return:       void
+* Exempel:
+*               delete debug => alla köade bilder finns på disk
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+DebugImages::~DebugImages() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->has_work.notify_all();
+	this->writer.join();
+}
+
+/** Beskrivning:  Påbörjar en bildruta. Varje config.every:e bildruta får en DebugFrame som stegen lägger sina bilder i, de andra får NULL
+*									och kostar ingenting. Bildrutans nummer och ström blir början på filnamnen, så att en bild kan kopplas till
+*									raden för samma bildruta i --output och --plate-log
+* Argument 1:   long - bildrutans nummer i strömmen
+* Argument 2:   const std::string& - strömmens namn, tomt för en enda video
+* Return:       DebugFrame* - pekare till bildrutans bilder, eller NULL ifall bildrutan inte ska sparas
+* Exempel:
+*               DebugFrame *frame = debug.begin(seq) => NULL för nio av tio bildrutor med --debug-every=10
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+DebugFrame* DebugImages::begin(long number, const std::string &stream) {
+	long seen = this->frames_seen++;
+	if (seen % this->config.every != 0)
+		return NULL;
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	DebugFrame *frame;
+	if (this->spare.empty()) {
+		this->frames.emplace_back(new DebugFrame(this->config));
+		frame = this->frames.back().get();
+	} else {
+		frame = this->spare.back();
+		this->spare.pop_back();
+	}
+	frame->used = 0;
+	frame->number = number;
+	frame->stream = stream;
+	return frame;
+}
+
+/** Beskrivning:  Avslutar en bildruta. Med config.misreads kastas bildrutor där en skylt lästes, annars ritas resultatet ut på en kopia
+*									som steget done och bildrutan lämnas till skrivartråden. Är kön full kastas bildrutan istället för att vänta
+* Argument 1:   DebugFrame* - pekare från begin(), eller NULL
+* Argument 2:   const cv::Mat& - referens till hela bildrutan
+* Argument 3:   const std::vector<Match>& - referens till bildrutans matchningar
+* Argument 4:   const std::vector<std::vector<cv::Point>>& - referens till kandidaterna matchningarna kom från
+* Return:       void
+* Exempel:
+*               debug.end(frame, image, matches, candidates) => bildrutans bilder skrivs i bakgrunden
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void DebugImages::end(DebugFrame *frame, const cv::Mat &image, const std::vector<Match> &matches, const std::vector<std::vector<cv::Point>> &candidates) {
+	if (frame == NULL)
+		return;
+
+	bool id_valid = false;
+	for (const Match &match : matches) {
+		if (match.id_valid)
+			id_valid = true;
+	}
+	if (this->config.misreads && id_valid) {
+		this->discard(frame);
+		return;
+	}
+	if (frame->wants("done")) {
+		std::lock_guard<std::mutex> lock(frame->mutex);
+		cv::Mat &done = frame->slot("done");
+		if (image.channels() == 1)
+			cv::cvtColor(image, done, cv::COLOR_GRAY2BGR); // Luma frames get three channels only here, so the matches are drawn in colour
+		else
+			image.copyTo(done);
+		drawMatches(done, matches, candidates);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->queue.size() >= this->config.queue_size) {
+			this->frames_dropped++;
+			this->spare.push_back(frame);
+			return;
+		}
+		this->queue.push_back(frame);
+	}
+	this->has_work.notify_one();
+}
+
+/** Beskrivning:  Lämnar tillbaka en bildruta utan att spara den, till exempel när pipelinen kastar bildrutan
+* Argument 1:   DebugFrame* - pekare från begin(), eller NULL
+* Return:       void
+* Exempel:
+*               debug.discard(frame) => buffertarna återanvänds av nästa bildruta
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void DebugImages::discard(DebugFrame *frame) {
+	if (frame == NULL)
+		return;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->spare.push_back(frame);
+}
+
+/** Beskrivning:  Skrivartråden, kodar och skriver en bildruta i taget i den ordning de avslutades. Filerna heter efter strömmen,
+*									bildrutans nummer och bildens ordning i bildrutan, så att flera utklipp från samma bildruta får egna namn
+* Return:       void
+* Exempel:
+*               std::thread(&DebugImages::write, this) => körs tills stopping är satt och kön är tom
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void DebugImages::write() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		this->has_work.wait(lock, [this] { return this->stopping || !this->queue.empty(); });
+		if (this->queue.empty())
+			break; // Stopping and drained
+		DebugFrame *frame = this->queue.front();
+		this->queue.pop_front();
+		lock.unlock();
+
+		std::string prefix = this->config.directory + "/";
+		if (!frame->stream.empty()) {
+			std::string stream = frame->stream;
+			std::replace(stream.begin(), stream.end(), '/', '_');
+			prefix += stream + "-";
+		}
+		prefix += std::to_string(frame->number) + "-";
+		for (size_t i = 0; i < frame->used; i++) {
+			cv::Mat &img = frame->images[i].second;
+			std::string path = prefix;
+			path += std::to_string(i);
+			path += "-";
+			path += frame->images[i].first;
+			path += this->config.format == DebugFormat::RAW && img.channels() != 1 ? ".ppm" : this->extension;
+			if (!cv::imwrite(path, img, this->params))
+				std::cerr << "Cannot write " << path << std::endl;
+		}
+
+		lock.lock();
+		this->images_written += frame->used;
+		this->frames_written++;
+		this->spare.push_back(frame);
+	}
+}
+
+/** Beskrivning:  Skriver hur många bildrutor och bilder som sparats och hur många bildrutor som kastades för att skrivaren inte hann med
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               debug.report(std::cout) => "Debug images: 1520 images from 95 of 950 frames, 3 frames dropped"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void DebugImages::report(std::ostream &out) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	out << "Debug images: " << this->images_written << " images from " << this->frames_written << " of " << this->frames_seen << " frames, "
+		<< this->frames_dropped << " frames dropped" << std::endl;
+}
@@ -0,0 +1,34 @@
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "detection_context.hpp"
+
+/** Beskrivning:  Konstruktor som skapar strukturelementen, bilderna skapas först när den första bildrutan kommer
+* Return:       DetectionContext - DetectionContext objekt
+* Exempel:
+*               DetectionContext detection => detection.rectangleKernel är 13 pixlar bred och 5 pixlar hög
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+DetectionContext::DetectionContext() {
+	this->largerKernel	= cv::getStructuringElement(cv::MORPH_RECT, cv::Size(4, 4));
+	this->rectangleKernel	= cv::getStructuringElement(cv::MORPH_RECT, cv::Size(13, 5));
+	this->squareKernel	= cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+}
+
+/** Beskrivning:  Räknar ut skalan från bildens pixlar till den upplösning kandidaterna letas i, den långa sidan blir processing_width, och
+*									hur stor en pixel i den upplösningen är i en bild hoptryckt till 512x512, där RECT_DIFF är satt
+* Argument 1:   cv::Size - storleken på hela bilden, även när bara en del av den ska sökas igenom
+* Return:       void
+* Exempel:
+*               detection.setFrameSize(cv::Size(1280, 720)) => detection.scale = 0.4 och detection.area_scale = 1.78 med processing_width 512
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void DetectionContext::setFrameSize(cv::Size frame) {
+	int long_side = std::max(1, std::max(frame.width, frame.height));
+	this->scale = std::max(1, this->processing_width) / (double) long_side;
+	this->area_scale = 512.0 * 512.0 / ((double) std::max(1, frame.width) * std::max(1, frame.height) * this->scale * this->scale);
+}
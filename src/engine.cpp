@@ -0,0 +1,151 @@
+#include <chrono>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "debug_images.hpp"
+#include "detection_context.hpp"
+#include "known_cars.hpp"
+#include "latency_budget.hpp"
+#include "metrics.hpp"
+#include "motion_gate.hpp"
+#include "ocr_pool.hpp"
+#include "tracker.hpp"
+#include "engine.hpp"
+
+/** Beskrivning:  Konstruktor som initierar allt instansen behöver, Tesseract motorerna startas här så att den första bildrutan inte betalar för det
+* Argument 1:   EngineConfig - konfiguration för instansen
+* Return:       Engine - Engine objekt
+* Exempel:
+*               Engine engine(config) => engine.ok() = true när alla motorer kunde initieras
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+Engine::Engine(EngineConfig config_in) {
+	this->config = config_in;
+	if (this->config.debug)
+		this->debug = new DebugImages(this->config.debug_config);
+	this->ocr = new OcrPool(this->config.ocr);
+
+	/* The list is reloaded when the file changes */
+	this->known_cars = new KnownCars(this->config.known_cars.c_str());
+	if (!this->config.known_cars.empty() && this->config.reload_interval > 0)
+		this->known_cars->watch(this->config.reload_interval);
+
+	if (this->config.track)
+		this->tracker = new PlateTracker(this->config.tracker);
+	if (this->config.motion)
+		this->gate = new MotionGate(this->config.motion_config);
+	if (this->config.budget)
+		this->budget = new LatencyBudget(this->config.budget_config);
+
+	this->detection.processing_width = this->config.processing_width;
+	this->detection.bands = this->config.bands;
+	this->shown = &this->detection.candidates;
+}
+
+/** Beskrivning:  Destruktor som stoppar Tesseract motorerna och bevakningen av listan och frigör allt instansen äger
+* Return:       void
+* Exempel:
+*               delete engine => alla trådar som hör till instansen är stoppade
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+Engine::~Engine() {
+	if (this->budget != NULL)
+		delete this->budget;
+	if (this->gate != NULL)
+		delete this->gate;
+	if (this->tracker != NULL)
+		delete this->tracker;
+	delete this->known_cars;
+	delete this->ocr;
+	if (this->debug != NULL)
+		delete this->debug;
+}
+
+/** Beskrivning:  Kontrollerar att alla Tesseract motorer och en eventuell ocr modell kunde initieras
+* Return:       bool - true ifall instansen kan användas
+* Exempel:
+*               engine.ok() => false ifall språket för Tesseract saknas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool Engine::ok() const {
+	return this->ocr->ok();
+}
+
+/** Beskrivning:  Kör hela anpr algoritmen på en bildruta: förändringsdetektering, lokalisering av kandidater och ocr med spårning.
+*									Bilden ändras inte, matchningarna ritas ut av den som anroppar med drawMatches() och candidates()
+* Argument 1:   const cv::Mat& - referens till bildrutan
+* Argument 2:   long - bildrutans nummer i strömmen för debug bildernas namn, -1 för antalet tidigare anropp
+* Return:       std::vector<Match> - bildrutans matchningar, för en oförändrad bildruta samma som förra bildrutans
+* Exempel:
+*               matches = engine.process(frame) => en Match för varje eventuell registreringsskylt samt dess status, ifall den är godkänd eller inte
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::vector<Match> Engine::process(const cv::Mat &frame, long number) {
+	long frame_number = this->frames++;
+	ScopedTimer timer(METRICS.frame);
+	METRICS.frames.add();
+	auto start = std::chrono::steady_clock::now();
+	cv::Mat image = frame; // Only a new header, no stage writes to the frame
+	if (this->budget != NULL) {
+		this->detection.processing_width = this->budget->processingWidth();
+		this->detection.keep = this->budget->candidates();
+	}
+	cv::Rect roi(0, 0, image.cols, image.rows);
+	if (this->gate != NULL && !this->gate->check(image, roi)) {
+		// Nothing moved, the previous result still holds
+		this->shown = &this->gate->held_candidates;
+		return this->gate->held_matches;
+	}
+
+	DebugFrame *debug = this->debug != NULL ? this->debug->begin(number >= 0 ? number : frame_number) : NULL;
+	this->detection.debug = debug;
+	std::vector<std::vector<cv::Point>> &candidates = locateCandidatesInRegion(image, roi, this->detection);
+	auto located = std::chrono::steady_clock::now();
+	if (this->tracker != NULL)
+		this->tracker->limitTo(roi);
+	std::vector<Match> matches = extract_ids(*this->ocr, image, candidates, *this->known_cars, this->tracker, debug);
+	auto recognized = std::chrono::steady_clock::now();
+	this->shown = &candidates;
+	if (this->gate != NULL) {
+		// Plates outside the part that moved keep their previous result
+		this->gate->hold(roi, matches, candidates);
+	}
+	if (this->budget != NULL) {
+		this->budget->observe(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+			std::chrono::duration<double, std::milli>(located - start).count(),
+			std::chrono::duration<double, std::milli>(recognized - located).count());
+	}
+	if (this->debug != NULL)
+		this->debug->end(debug, image, matches, candidates);
+	return matches;
+}
+
+/** Beskrivning:  Skriver statistik från alla delar av instansen som är påslagna: ocr, tidsbudget, förändringsdetektering, debug bilder och spårning
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               engine.report(std::cout) => "Tracker ran OCR on 120 candidates and skipped 480"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Engine::report(std::ostream &out) {
+	this->ocr->report(out);
+	if (this->budget != NULL)
+		this->budget->report(out);
+	if (this->gate != NULL)
+		this->gate->report(out);
+	if (this->debug != NULL)
+		this->debug->report(out);
+	if (this->tracker != NULL)
+		out << "Tracker ran OCR on " << this->tracker->ocrRuns() << " candidates and skipped " << this->tracker->ocrSkips() << std::endl;
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "event_writer.hpp"
+
+/** Beskrivning:  Kodar en sträng för att stå inom citattecken i JSON
+* Argument 1:   const std::string& - strängen
+* Return:       std::string - kodad sträng utan citattecken runt
+* Exempel:
+*               json_escape("a\"b") => "a\\\"b"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string json_escape(const std::string &value) {
+	std::string escaped;
+	for (char c : value) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		} else if ((unsigned char) c < 0x20) {
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", c);
+			escaped += code;
+		} else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+/** Beskrivning:  Kodar ett fält för CSV, fält med kommatecken, citattecken eller radbrytningar sätts inom citattecken
+* Argument 1:   const std::string& - fältet
+* Return:       std::string - kodat fält
+* Exempel:
+*               csv_escape("gate, north") => "\"gate, north\""
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string csv_escape(const std::string &value) {
+	if (value.find_first_of(",\"\n\r") == std::string::npos)
+		return value;
+	std::string escaped = "\"";
+	for (char c : value) {
+		if (c == '"')
+			escaped += '"';
+		escaped += c;
+	}
+	return escaped + "\"";
+}
+
+/** Beskrivning:  Konstruktor som öppnar filen, eller använder stdout, och skriver en rubrikrad ifall formatet är CSV
+* Argument 1:   const std::string& - sökväg till filen, "-" för stdout
+* Argument 2:   EventFormat - format på raderna
+* Argument 3:   EventTag - ifall raderna märks med strömmens namn eller bildens sökväg
+* Return:       EventWriter - EventWriter objekt
+* Exempel:
+*               EventWriter events("plates.csv", EventFormat::CSV) => plates.csv skapas med en rubrikrad
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+EventWriter::EventWriter(const std::string &path, EventFormat format_in, EventTag tag_in) {
+	this->format = format_in;
+	this->tag = tag_in;
+	if (path == "-") {
+		this->out = &std::cout;
+	} else {
+		this->file.open(path, std::ios::out | std::ios::trunc);
+		this->out = this->file.is_open() ? &this->file : nullptr;
+	}
+	if (this->ok() && this->format == EventFormat::CSV)
+		*this->out << (this->tag == EventTag::STREAM ? "stream," : this->tag == EventTag::IMAGE ? "image," : "") << "frame,time_ms,latency_ms,frame_parking_valid,frame_id_valid,id,id_valid,parking_valid,x,y,width,height\n";
+}
+
+/** Beskrivning:  Skriver en bildrutas resultat, en rad för JSON och en rad per matchning för CSV. Strömmen töms efter varje bildruta
+*									så att resultatet kan läsas av ett annat program medan videon körs
+* Argument 1:   const FrameEvent& - information om bildrutan
+* Argument 2:   const std::vector<Match>& - bildrutans matchningar, rektanglarna i bildens pixlar
+* Return:       void
+* Exempel:
+*               events.write(event, matches) => en rad skrivs per bildruta (JSON) eller per matchning (CSV)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void EventWriter::write(const FrameEvent &event, const std::vector<Match> &matches) {
+	if (!this->ok())
+		return;
+	std::ostream &out = *this->out;
+
+	if (this->format == EventFormat::JSON) {
+		out << "{";
+		if (this->tag == EventTag::STREAM)
+			out << "\"stream\":\"" << json_escape(event.stream) << "\",";
+		else if (this->tag == EventTag::IMAGE)
+			out << "\"image\":\"" << json_escape(event.image) << "\",";
+		// Fixed notation, the stream's default six digits would turn a long position or a capture timestamp into 1.79223e+12
+		char times[96];
+		snprintf(times, sizeof(times), ",\"time_ms\":%.3f,\"latency_ms\":%.3f", event.position_ms, event.latency_ms);
+		out << "\"frame\":" << event.frame
+			<< times
+			<< ",\"parking_valid\":" << (event.parking_valid ? "true" : "false")
+			<< ",\"id_valid\":" << (event.id_valid ? "true" : "false")
+			<< ",\"plates\":[";
+		for (size_t i = 0; i < matches.size(); i++) {
+			const Match &match = matches[i];
+			out << (i > 0 ? "," : "")
+				<< "{\"id\":\"" << match.id << "\"" // parse_answer only lets [A-Z0-9] through, nothing to escape
+				<< ",\"id_valid\":" << (match.id_valid ? "true" : "false")
+				<< ",\"parking_valid\":" << (match.parking_valid ? "true" : "false")
+				<< ",\"x\":" << match.rectangle.x
+				<< ",\"y\":" << match.rectangle.y
+				<< ",\"width\":" << match.rectangle.width
+				<< ",\"height\":" << match.rectangle.height
+				<< "}";
+		}
+		out << "]}\n";
+	} else {
+		std::string prefix = (this->tag == EventTag::STREAM ? csv_escape(event.stream) + "," : this->tag == EventTag::IMAGE ? csv_escape(event.image) + "," : "")
+			+ std::to_string(event.frame) + ","
+			+ std::to_string(event.position_ms) + ","
+			+ std::to_string(event.latency_ms) + ","
+			+ (event.parking_valid ? "1" : "0") + ","
+			+ (event.id_valid ? "1" : "0") + ",";
+		if (matches.empty())
+			out << prefix << ",,,,,,\n";
+		for (const Match &match : matches) {
+			out << prefix
+				<< match.id << ","
+				<< (match.id_valid ? 1 : 0) << ","
+				<< (match.parking_valid ? 1 : 0) << ","
+				<< match.rectangle.x << ","
+				<< match.rectangle.y << ","
+				<< match.rectangle.width << ","
+				<< match.rectangle.height << "\n";
+		}
+	}
+	out.flush();
+}
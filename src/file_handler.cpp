@@ -1,6 +1,12 @@
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "known_cars.hpp"
 #include "file_handler.hpp"
 
 /** Beskrivning:  Detta är en konstruktor som sätter privata variabler i klassen FileHandler
@@ -33,3 +39,50 @@ std::vector<std::string> FileHandler::getIDs(){
 	}
 	return ids;
 }
+
+/** Beskrivning:  Funktionen mappar filen på sökvägen this->path i minnet och packar varje rad till ett heltal med pack_plate(), utan att skapa en sträng per rad.
+*									Rader som inte är en giltig registreringsskylt hoppas över
+* Return:       std::vector<uint32_t> - vector av packade registreringsskyltar, tom ifall filen inte kunde läsas
+* Exempel:
+*               getPackedIDs() => [packad "YAH088", packad "MSF492"] ifall filen innehåller raderna "YAH088" och "MSF492"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::vector<uint32_t> FileHandler::getPackedIDs(){
+	std::vector<uint32_t> ids;
+	int fd = open(this->path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return ids;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close(fd);
+		return ids;
+	}
+	size_t length = info.st_size;
+	void *mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED)
+		return ids;
+	madvise(mapped, length, MADV_SEQUENTIAL);
+
+	const char *data = (const char*) mapped;
+	const char *end = data + length;
+	ids.reserve(length / (PLATE_LENGTH + 1));
+	while (data < end) {
+		const char *line_end = (const char*) memchr(data, '\n', end - data);
+		if (line_end == NULL)
+			line_end = end;
+		size_t line_length = line_end - data;
+		if (line_length > 0 && data[line_length - 1] == '\r')
+			line_length--; // Lists saved on windows
+		uint32_t packed;
+		if (pack_plate(data, line_length, packed))
+			ids.push_back(packed);
+		data = line_end + 1;
+	}
+
+	munmap(mapped, length);
+	return ids;
+}
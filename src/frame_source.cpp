@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "frame_source.hpp"
+#include "metrics.hpp"
+
+/** Beskrivning:  Konstruktor som läser strömmens bildfrekvens, eller använder config.source_fps ifall strömmen inte har någon rimlig. Med luma
+*									ombeds avkodaren att låta bli färgkonverteringen, FFmpeg lämnar då Y planet och V4L2 rå YUYV
+* Argument 1:   cv::VideoCapture& - referens till en öppen videoström, måste leva lika länge som objektet
+* Argument 2:   SamplingConfig - läge och takt
+* Argument 3:   bool - true för att läsa bildrutorna i gråskala
+* Return:       FrameSource - FrameSource objekt
+* Exempel:
+*               FrameSource source(cap, config, false) => source.sourceFps() är 25 för en 25 fps fil
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+FrameSource::FrameSource(cv::VideoCapture &cap_in, SamplingConfig config_in, bool luma_in) : cap(cap_in) {
+	this->config = config_in;
+	this->luma = luma_in;
+	if (this->luma)
+		this->cap.set(cv::CAP_PROP_CONVERT_RGB, 0);
+	this->config.stride = std::max(1, this->config.stride);
+	this->source_fps = this->cap.get(cv::CAP_PROP_FPS);
+	if (!(this->source_fps > 0 && this->source_fps <= 1000)) // Some cameras report 0 or the timebase instead
+		this->source_fps = this->config.source_fps > 0 ? this->config.source_fps : 25;
+}
+
+/** Beskrivning:  Räknar ut hur många bildrutor strömmen ska flyttas fram till nästa bildruta som analyseras, kan vara ett bråktal
+* Return:       double - antal bildrutor, minst 1
+* Exempel:
+*               interval() => 5.0 med FPS, fps 5 och en 25 fps ström
+*               interval() => 1.0 med ADAPTIVE och active_fps 0 de första två sekunderna efter en läst skylt
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+double FrameSource::interval() const {
+	double fps;
+	switch (this->config.mode) {
+	case SamplingMode::ALL:
+		return 1;
+	case SamplingMode::STRIDE:
+		return this->config.stride;
+	case SamplingMode::FPS:
+		fps = this->config.fps;
+		break;
+	case SamplingMode::ADAPTIVE:
+	default:
+		fps = this->position - this->last_plate.load(std::memory_order_relaxed) <= this->config.hold_seconds * this->source_fps
+			? this->config.active_fps : this->config.fps;
+		break;
+	}
+	if (fps <= 0)
+		return 1;
+	return std::max(1.0, this->source_fps / fps);
+}
+
+/** Beskrivning:  Läser nästa bildruta som ska analyseras. Bildrutorna före den tas med grab() utan retrieve()
+* Argument 1:   cv::Mat& - referens till bilden som bildrutan läses in i
+* Argument 2:   int - minsta antal bildrutor att flytta fram, till exempel LatencyBudget::frameStride(). Det största av detta och samplingens intervall gäller
+* Return:       bool - false när strömmen är slut eller kameran kopplats bort
+* Exempel:
+*               source.read(frame) => true, med STRIDE och stride 3 har två bildrutor hoppats över
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool FrameSource::read(cv::Mat &frame, int min_stride) {
+	this->owed += std::max((double) std::max(1, min_stride), this->interval());
+	long advance = std::max(1L, (long) this->owed);
+	this->owed -= advance;
+
+	for (long i = 0; i < advance; i++) {
+		auto start = std::chrono::steady_clock::now();
+		bool grabbed = this->cap.grab();
+		this->grab_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (!grabbed)
+			return false;
+		this->position++;
+		this->frames_grabbed++;
+		METRICS.frames_grabbed.add();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	cv::Mat &target = this->luma && !this->native_luma ? this->decoded : frame;
+	bool retrieved = this->cap.retrieve(target);
+	if (retrieved && this->luma && (target.channels() != 1 || &target != &frame)) {
+		// The backend ignored CAP_PROP_CONVERT_RGB, later frames are retrieved into a buffer of their own and converted from there
+		this->native_luma = false;
+		if (target.channels() == 2)
+			cv::cvtColor(target, frame, cv::COLOR_YUV2GRAY_YUY2);
+		else if (target.channels() == 4)
+			cv::cvtColor(target, frame, cv::COLOR_BGRA2GRAY);
+		else if (target.channels() == 3)
+			cv::cvtColor(target, frame, cv::COLOR_BGR2GRAY);
+		else
+			target.copyTo(frame);
+		this->luma_converted++;
+	}
+	this->retrieve_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (!retrieved)
+		return false;
+	this->frames_retrieved++;
+	METRICS.frames_retrieved.add();
+	this->analysed_position.store(this->position, std::memory_order_relaxed);
+	return true;
+}
+
+/** Beskrivning:  Berättar om en skylt lästes i den senast analyserade bildrutan, används av ADAPTIVE. I pipelinen kommer resultatet några bildrutor
+*									efter att bildrutan lästes, vilket bara förlänger den högre takten lika mycket
+* Argument 1:   bool - true ifall en giltig skylt lästes
+* Return:       void
+* Exempel:
+*               source.observe(job.id_valid) => takten är active_fps i config.hold_seconds sekunder video
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void FrameSource::observe(bool plate_in_view) {
+	if (plate_in_view)
+		this->last_plate.store(this->analysed_position.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+/** Beskrivning:  Skriver hur många bildrutor som analyserades och den uppmätta besparingen, det vill säga retrieve() tiden för de bildrutor som bara togs med grab()
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               source.report(std::cout) => "Sampling: analysed 300 of 1500 frames at 25 fps, grab 1.2ms and retrieve 2.3ms per frame, saved 2760ms (52% of reading every frame)"
+*               source.report(std::cout) => "..., luma from the decoder" med luma
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void FrameSource::report(std::ostream &out) {
+	if (this->frames_grabbed == 0)
+		return;
+	double grab = this->grab_ms / this->frames_grabbed;
+	double retrieve = this->frames_retrieved > 0 ? this->retrieve_ms / this->frames_retrieved : 0;
+	double saved = (this->frames_grabbed - this->frames_retrieved) * retrieve;
+	double every_frame = this->frames_grabbed * (grab + retrieve);
+	out << "Sampling: analysed " << this->frames_retrieved << " of " << this->frames_grabbed << " frames at " << this->source_fps << " fps, grab "
+		<< grab << "ms and retrieve " << retrieve << "ms per frame, saved " << saved << "ms ("
+		<< (every_frame > 0 ? saved / every_frame * 100 : 0) << "% of reading every frame)";
+	if (this->luma && this->luma_converted == 0)
+		out << ", luma from the decoder";
+	else if (this->luma)
+		out << ", luma converted from colour on " << this->luma_converted << " frames";
+	out << std::endl;
+}
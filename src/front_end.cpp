@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "detection_context.hpp"
+#include "front_end.hpp"
+#include "gradient.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FRONT_END_SSE2
+#endif
+
+// The structuring elements of DetectionContext, anchored in the middle like cv::getStructuringElement does
+#define ISLAND_SIZE 4		// largerKernel, reaches 2 rows up and 1 down
+#define RECT_WIDTH 13		// rectangleKernel, reaches 2 rows each way
+#define RECT_HEIGHT 5
+
+// Rows first to last of an image, either a band buffer or the whole frame
+struct BandRows {
+	uint8_t *data;
+	size_t step;
+	int first;
+	int last;
+
+	uint8_t* row(int y) const { return this->data + (size_t) (y - this->first) * this->step; }
+};
+
+/** Beskrivning:  Gör en buffert i bandet stor nog för raderna first till last, bufferten behåller sin kapacitet mellan bildrutor
+* Argument 1:   std::vector<uint8_t>& - referens till bandets buffert
+* Argument 2:   int - första raden
+* Argument 3:   int - raden efter den sista
+* Argument 4:   int - antal kolumner
+* Return:       BandRows - raderna i bufferten
+* Exempel:
+*               band_rows(band.opened, 27, 69, 512) => rad 27 till 68 i band.opened
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static BandRows band_rows(std::vector<uint8_t> &buffer, int first, int last, int cols) {
+	buffer.resize((size_t) std::max(0, last - first) * cols);
+	return { buffer.data(), (size_t) cols, first, last };
+}
+
+/** Beskrivning:  Speglar ett index utanför bilden som BORDER_REFLECT_101, kanten själv upprepas inte
+* Argument 1:   int - index, får vara utanför bilden
+* Argument 2:   int - antal rader eller kolumner
+* Return:       int - index i bilden
+* Exempel:
+*               reflect_101(-2, 10) => 2
+*               reflect_101(10, 10) => 8
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static inline int reflect_101(int i, int n) {
+	if (n == 1)
+		return 0;
+	while (i < 0 || i >= n)
+		i = i < 0 ? -i : 2 * n - 2 - i;
+	return i;
+}
+
+template<bool DILATE>
+static inline uint8_t extreme(uint8_t a, uint8_t b) {
+	return DILATE ? std::max(a, b) : std::min(a, b);
+}
+
+/** Beskrivning:  Min eller max av två rader pixel för pixel, 16 pixlar åt gången med SSE2. dst får vara samma som a, och b får ligga efter a
+*									i samma rad eftersom varje block läses innan det skrivs
+* Argument 1:   uint8_t* - pekare där resultatet sparas
+* Argument 2:   const uint8_t* - pekare till första raden
+* Argument 3:   const uint8_t* - pekare till andra raden
+* Argument 4:   int - antal pixlar
+* Return:       void
+* Exempel:
+*               extreme_rows<false>(out, a, b, 512) => out[x] = min(a[x], b[x])
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+template<bool DILATE>
+static void extreme_rows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int n) {
+	int x = 0;
+#ifdef FRONT_END_SSE2
+	for (; x + 16 <= n; x += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i*) (a + x));
+		__m128i vb = _mm_loadu_si128((const __m128i*) (b + x));
+		_mm_storeu_si128((__m128i*) (dst + x), DILATE ? _mm_max_epu8(va, vb) : _mm_min_epu8(va, vb));
+	}
+#endif
+	for (; x < n; x++)
+		dst[x] = extreme<DILATE>(a[x], b[x]);
+}
+
+/** Beskrivning:  Erode eller dilate med en rektangulär kärna för raderna first till last, separerad i två pass. Vertikalt körs van Herk och
+*									Gil-Werman över raderna: raderna delas i block lika höga som kärnan, och varje utrad är min eller max av suffixet i
+*									ett block och prefixet i nästa, tre operationer per pixel oavsett kärnans höjd och hela rader åt gången med SSE2.
+*									Horisontellt är samma rekursion sekventiell längs raden, så där dubblas fönstret istället med förskjutna rader,
+*									1, 2, 4 och 8 pixlar för en kärna 13 bred. Pixlar utanför bilden räknas inte, som med standardkanten för
+*									cv::erode och cv::dilate, så resultatet är exakt samma som på hela bilden så länge src har raderna kärnan når
+* Argument 1:   const BandRows& - indata, minst raderna first - anchor_y till last - anchor_y + height - 1 som finns i bilden
+* Argument 2:   const BandRows& - resultatet, minst raderna first till last
+* Argument 3:   int - första raden
+* Argument 4:   int - raden efter den sista
+* Argument 5:   int - kärnans bredd
+* Argument 6:   int - kärnans höjd
+* Argument 7:   int - ankarets kolumn i kärnan
+* Argument 8:   int - ankarets rad i kärnan
+* Argument 9:   const FrontEndFrame& - bildens storlek
+* Argument 10:  FrontEndBand& - referens till bandet vars arbetsytor används
+* Return:       void
+* Exempel:
+*               band_morphology<true>(opened, dilated, 37, 75, 13, 5, 6, 2, frame, band) => samma rader som cv::dilate med rectangleKernel
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+template<bool DILATE>
+static void band_morphology(const BandRows &src, const BandRows &dst, int first, int last, int width, int height, int anchor_x, int anchor_y,
+		const FrontEndFrame &frame, FrontEndBand &band) {
+	const uint8_t neutral = DILATE ? 0 : 255;
+	int cols = frame.cols;
+	int count = last - first + height - 1; // Source rows the output rows reach, starting at first - anchor_y
+	if (last <= first)
+		return;
+	band.prefix.resize((size_t) count * cols);
+	band.suffix.resize((size_t) count * cols);
+	band.border.assign(cols, neutral);
+	auto source = [&](int j) -> const uint8_t* {
+		int y = first - anchor_y + j;
+		return y >= 0 && y < frame.rows ? src.row(y) : band.border.data();
+	};
+	auto prefix = [&](int j) { return band.prefix.data() + (size_t) j * cols; };
+	auto suffix = [&](int j) { return band.suffix.data() + (size_t) j * cols; };
+
+	for (int start = 0; start < count; start += height) {
+		int end = std::min(start + height, count);
+		memcpy(prefix(start), source(start), cols);
+		for (int j = start + 1; j < end; j++)
+			extreme_rows<DILATE>(prefix(j), prefix(j - 1), source(j), cols);
+		memcpy(suffix(end - 1), source(end - 1), cols);
+		for (int j = end - 2; j >= start; j--)
+			extreme_rows<DILATE>(suffix(j), suffix(j + 1), source(j), cols);
+	}
+
+	int length = cols + width - 1;
+	band.padded.resize(length);
+	uint8_t *padded = band.padded.data();
+	for (int i = 0; i < last - first; i++) {
+		std::fill(padded, padded + anchor_x, neutral);
+		std::fill(padded + anchor_x + cols, padded + length, neutral);
+		extreme_rows<DILATE>(padded + anchor_x, suffix(i), prefix(i + height - 1), cols);
+		int span = 1;
+		for (; span * 2 <= width; span *= 2)
+			extreme_rows<DILATE>(padded, padded, padded + span, length - 2 * span + 1);
+		extreme_rows<DILATE>(dst.row(first + i), padded, padded + width - span, cols);
+	}
+}
+
+/** Beskrivning:  Gaussisk 5x5 blur som cv::GaussianBlur med ksize 5 och sigma 0 på 8 bitar. OpenCV använder då kärnan [1 4 6 4 1] / 16 i
+*									fixpunkt utan avrundning mellan passen, så resultatet är summan / 256 avrundat uppåt vid hälften
+* Argument 1:   const BandRows& - indata, minst raderna first - 2 till last + 2 som finns i bilden
+* Argument 2:   const BandRows& - resultatet
+* Argument 3:   int - första raden
+* Argument 4:   int - raden efter den sista
+* Argument 5:   const FrontEndFrame& - bildens storlek
+* Argument 6:   FrontEndBand& - referens till bandet vars arbetsytor används
+* Return:       void
+* Exempel:
+*               band_blur(normalized, blur, 33, 79, frame, band) => samma rader som cv::GaussianBlur(gradX, blur, cv::Size(5, 5), 0)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static void band_blur(const BandRows &src, const BandRows &dst, int first, int last, const FrontEndFrame &frame, FrontEndBand &band) {
+	static const uint32_t kernel[5] = { 1, 4, 6, 4, 1 };
+	int cols = frame.cols;
+	band.sums.resize(cols);
+	uint16_t *sums = band.sums.data();
+	for (int y = first; y < last; y++) {
+		const uint8_t *in[5];
+		for (int k = 0; k < 5; k++)
+			in[k] = src.row(reflect_101(y + k - 2, frame.rows));
+		// Both sums are at most 255 * 256, so they fit in 16 bits together with the rounding
+		int x = 0;
+#ifdef FRONT_END_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (; x + 8 <= cols; x += 8) {
+			__m128i r0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (in[0] + x)), zero);
+			__m128i r1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (in[1] + x)), zero);
+			__m128i r2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (in[2] + x)), zero);
+			__m128i r3 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (in[3] + x)), zero);
+			__m128i r4 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (in[4] + x)), zero);
+			__m128i sum = _mm_add_epi16(_mm_add_epi16(r0, r4), _mm_slli_epi16(_mm_add_epi16(_mm_add_epi16(r1, r3), r2), 2));
+			_mm_storeu_si128((__m128i*) (sums + x), _mm_add_epi16(sum, _mm_add_epi16(r2, r2)));
+		}
+#endif
+		for (; x < cols; x++)
+			sums[x] = in[0][x] + 4 * in[1][x] + 6 * in[2][x] + 4 * in[3][x] + in[4][x];
+
+		uint8_t *out = dst.row(y);
+		auto edge = [&](int x) {
+			uint32_t sum = 0;
+			for (int k = 0; k < 5; k++)
+				sum += kernel[k] * sums[reflect_101(x + k - 2, cols)];
+			out[x] = (uint8_t) ((sum + 128) >> 8);
+		};
+		for (x = 0; x < std::min(2, cols); x++)
+			edge(x);
+#ifdef FRONT_END_SSE2
+		const __m128i half = _mm_set1_epi16(128);
+		for (; x + 8 <= cols - 2; x += 8) {
+			__m128i s0 = _mm_loadu_si128((const __m128i*) (sums + x - 2));
+			__m128i s1 = _mm_loadu_si128((const __m128i*) (sums + x - 1));
+			__m128i s2 = _mm_loadu_si128((const __m128i*) (sums + x));
+			__m128i s3 = _mm_loadu_si128((const __m128i*) (sums + x + 1));
+			__m128i s4 = _mm_loadu_si128((const __m128i*) (sums + x + 2));
+			__m128i sum = _mm_add_epi16(_mm_add_epi16(s0, s4), _mm_slli_epi16(_mm_add_epi16(_mm_add_epi16(s1, s3), s2), 2));
+			sum = _mm_add_epi16(_mm_add_epi16(sum, _mm_add_epi16(s2, s2)), half);
+			__m128i packed = _mm_packus_epi16(_mm_srli_epi16(sum, 8), zero);
+			_mm_storel_epi64((__m128i*) (out + x), packed);
+		}
+#endif
+		for (; x < cols - 2; x++)
+			out[x] = (uint8_t) ((sums[x - 2] + 4 * sums[x - 1] + 6 * sums[x] + 4 * sums[x + 1] + sums[x + 2] + 128) >> 8);
+		for (; x < cols; x++)
+			edge(x);
+	}
+}
+
+/** Beskrivning:  Första fasen av locate_front_end() för ett band: open 4x4, close 13x5 minus det öppnade (blackhat) och Scharr gradienten.
+*									Stegen kedjas per band så att raderna är kvar i cachen, och varje steg räknar de extra rader nästa steg behöver
+*									ovanför och under bandet. Bandets rader av det öppnade, blackhat och gradienten skrivs till bilderna i frame
+* Argument 1:   const FrontEndFrame& - bilderna, gray läses och opened, blackhat och magnitude skrivs
+* Argument 2:   FrontEndBand& - referens till bandet, band.max_gradient sätts
+* Return:       void
+* Exempel:
+*               front_end_gradient(frame, band) => rad band.first till band.last av frame.magnitude
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void front_end_gradient(const FrontEndFrame &frame, FrontEndBand &band) {
+	int rows = frame.rows;
+	int cols = frame.cols;
+	int first = band.first;
+	int last = band.last;
+	auto clip = [rows](int y) { return std::max(0, std::min(rows, y)); };
+
+	// Each step needs the rows its kernel reaches around the rows the next step needs, and the gradient needs one more each way
+	BandRows gray = { (uint8_t*) frame.gray, frame.gray_step, 0, rows };
+	BandRows eroded = band_rows(band.eroded, clip(first - 7), clip(last + 6), cols);
+	BandRows opened = band_rows(band.opened, clip(first - 5), clip(last + 5), cols);
+	BandRows dilated = band_rows(band.dilated, clip(first - 3), clip(last + 3), cols);
+	BandRows blackhat = band_rows(band.blackhat, clip(first - 1), clip(last + 1), cols);
+
+	const int island_anchor = ISLAND_SIZE / 2;
+	band_morphology<false>(gray, eroded, eroded.first, eroded.last, ISLAND_SIZE, ISLAND_SIZE, island_anchor, island_anchor, frame, band);
+	band_morphology<true>(eroded, opened, opened.first, opened.last, ISLAND_SIZE, ISLAND_SIZE, island_anchor, island_anchor, frame, band);
+	band_morphology<true>(opened, dilated, dilated.first, dilated.last, RECT_WIDTH, RECT_HEIGHT, RECT_WIDTH / 2, RECT_HEIGHT / 2, frame, band);
+	band_morphology<false>(dilated, blackhat, blackhat.first, blackhat.last, RECT_WIDTH, RECT_HEIGHT, RECT_WIDTH / 2, RECT_HEIGHT / 2, frame, band);
+	for (int y = blackhat.first; y < blackhat.last; y++) {
+		uint8_t *closed = blackhat.row(y);
+		const uint8_t *open = opened.row(y);
+		int x = 0;
+#ifdef FRONT_END_SSE2
+		for (; x + 16 <= cols; x += 16) {
+			__m128i c = _mm_loadu_si128((const __m128i*) (closed + x));
+			_mm_storeu_si128((__m128i*) (closed + x), _mm_subs_epu8(c, _mm_loadu_si128((const __m128i*) (open + x))));
+		}
+#endif
+		for (; x < cols; x++)
+			closed[x] = closed[x] > open[x] ? closed[x] - open[x] : 0;
+	}
+
+	band.max_gradient = 0;
+	for (int y = first; y < last; y++) {
+		const uint8_t *up = blackhat.row(y > 0 ? y - 1 : std::min(1, rows - 1));
+		const uint8_t *down = blackhat.row(y < rows - 1 ? y + 1 : std::max(0, rows - 2));
+		scharr_x_row(up, blackhat.row(y), down, frame.magnitude + (size_t) y * cols, cols, band.max_gradient);
+		memcpy(frame.opened + y * frame.opened_step, opened.row(y), cols);
+		memcpy(frame.blackhat + y * frame.blackhat_step, blackhat.row(y), cols);
+	}
+}
+
+/** Beskrivning:  Andra fasen av locate_front_end() för ett band, när gradientens max i hela bilden är känt: normalisering, blur 5x5 och
+*									close 13x5. Bandets rader av blur och det stängda skrivs till bilderna i frame, och histogrammet för Otsu räknas
+* Argument 1:   const FrontEndFrame& - bilderna, magnitude läses och blur och closed skrivs
+* Argument 2:   const uint8_t* - pekare till tabellen från scharr_x_table() för bildens max
+* Argument 3:   FrontEndBand& - referens till bandet, band.histogram sätts
+* Return:       void
+* Exempel:
+*               front_end_close(frame, table, band) => rad band.first till band.last av frame.closed
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void front_end_close(const FrontEndFrame &frame, const uint8_t *table, FrontEndBand &band) {
+	int rows = frame.rows;
+	int cols = frame.cols;
+	int first = band.first;
+	int last = band.last;
+	auto clip = [rows](int y) { return std::max(0, std::min(rows, y)); };
+
+	BandRows normalized = band_rows(band.normalized, clip(first - 6), clip(last + 6), cols);
+	BandRows blur = band_rows(band.blur, clip(first - 4), clip(last + 4), cols);
+	BandRows dilated = band_rows(band.dilated, clip(first - 2), clip(last + 2), cols);
+	BandRows closed = { frame.closed, frame.closed_step, 0, rows };
+
+	for (int y = normalized.first; y < normalized.last; y++) {
+		const uint16_t *in = frame.magnitude + (size_t) y * cols;
+		uint8_t *out = normalized.row(y);
+		for (int x = 0; x < cols; x++)
+			out[x] = table[in[x]];
+	}
+	band_blur(normalized, blur, blur.first, blur.last, frame, band);
+	band_morphology<true>(blur, dilated, dilated.first, dilated.last, RECT_WIDTH, RECT_HEIGHT, RECT_WIDTH / 2, RECT_HEIGHT / 2, frame, band);
+	band_morphology<false>(dilated, closed, first, last, RECT_WIDTH, RECT_HEIGHT, RECT_WIDTH / 2, RECT_HEIGHT / 2, frame, band);
+
+	std::fill(band.histogram, band.histogram + 256, 0);
+	for (int y = first; y < last; y++) {
+		const uint8_t *out = closed.row(y);
+		for (int x = 0; x < cols; x++)
+			band.histogram[out[x]]++;
+		memcpy(frame.blur + y * frame.blur_step, blur.row(y), cols);
+	}
+}
+
+/** Beskrivning:  Otsus tröskel från ett histogram, samma beräkning som cv::threshold med THRESH_OTSU gör på bilden
+* Argument 1:   const uint32_t* - pekare till histogrammet, 256 element
+* Argument 2:   long - antal pixlar
+* Return:       int - tröskeln, pixlar över den blir 255
+* Exempel:
+*               front_end_otsu(histogram, 512 * 288) => 87
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int front_end_otsu(const uint32_t *histogram, long pixels) {
+	double scale = 1.0 / std::max(1L, pixels);
+	double mu = 0;
+	for (int i = 0; i < 256; i++)
+		mu += i * (double) histogram[i];
+	mu *= scale;
+
+	double mu1 = 0, q1 = 0, max_sigma = 0, max_value = 0;
+	for (int i = 0; i < 256; i++) {
+		double p_i = histogram[i] * scale;
+		mu1 *= q1;
+		q1 += p_i;
+		double q2 = 1. - q1;
+		if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1. - FLT_EPSILON)
+			continue;
+		mu1 = (mu1 + i * p_i) / q1;
+		double mu2 = (mu - q1 * mu1) / q2;
+		double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+		if (sigma > max_sigma) {
+			max_sigma = sigma;
+			max_value = i;
+		}
+	}
+	return (int) max_value;
+}
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cmath>
+#include "gradient.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GRADIENT_X86
+#endif
+
+// Rows of the 3x3 neighbourhood, the outer rows are mirrored at the image border like BORDER_REFLECT_101
+struct GradientRows {
+	const uint8_t *up;
+	const uint8_t *mid;
+	const uint8_t *down;
+};
+
+typedef void (*GradientRowFn)(const GradientRows &rows, uint16_t *out, int cols, uint16_t &hi);
+
+/** Beskrivning:  Absolutbeloppet av den horisontella Scharr gradienten i en punkt, kärnan är [-3 0 3; -10 0 10; -3 0 3]
+* Argument 1:   const GradientRows& - raderna ovanför, i och under punkten
+* Argument 2:   int - kolumnen, mellan 1 och bredden - 2
+* Return:       uint16_t - gradientens absolutbelopp, högst SCHARR_X_MAX
+* Exempel:
+*               scharr_at(rows, 10) => 0 i en jämn yta
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static inline uint16_t scharr_at(const GradientRows &rows, int x) {
+	int a = rows.up[x + 1] - rows.up[x - 1];
+	int b = rows.mid[x + 1] - rows.mid[x - 1];
+	int c = rows.down[x + 1] - rows.down[x - 1];
+	int g = 3 * (a + c) + 10 * b;
+	return (uint16_t) (g < 0 ? -g : g);
+}
+
+/** Beskrivning:  Skalär beräkning av en rad från en given kolumn, används för de sista kolumnerna i de vektoriserade versionerna
+* Argument 1:   const GradientRows& - raderna ovanför, i och under
+* Argument 2:   uint16_t* - pekare till radens gradient
+* Argument 3:   int - första kolumnen
+* Argument 4:   int - bildens bredd
+* Argument 5:   uint16_t& - största värdet hittills
+* Return:       void
+* Exempel:
+*               gradient_row_tail(rows, out, 497, 512, hi) => kolumn 497 till 510 räknas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static void gradient_row_tail(const GradientRows &rows, uint16_t *out, int x, int cols, uint16_t &hi) {
+	for (; x < cols - 1; x++) {
+		uint16_t g = scharr_at(rows, x);
+		out[x] = g;
+		hi = std::max(hi, g);
+	}
+}
+
+/** Beskrivning:  Skalär version av en rad, används när processorn saknar SSE4.1
+* Argument 1:   const GradientRows& - raderna ovanför, i och under
+* Argument 2:   uint16_t* - pekare till radens gradient
+* Argument 3:   int - bildens bredd
+* Argument 4:   uint16_t& - största värdet hittills
+* Return:       void
+* Exempel:
+*               gradient_row_scalar(rows, out, 512, hi)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static void gradient_row_scalar(const GradientRows &rows, uint16_t *out, int cols, uint16_t &hi) {
+	gradient_row_tail(rows, out, 1, cols, hi);
+}
+
+#ifdef GRADIENT_X86
+/** Beskrivning:  SSE4.1 version av en rad, åtta pixlar åt gången i 16 bitars heltal
+* Argument 1:   const GradientRows& - raderna ovanför, i och under
+* Argument 2:   uint16_t* - pekare till radens gradient
+* Argument 3:   int - bildens bredd
+* Argument 4:   uint16_t& - största värdet hittills
+* Return:       void
+* Exempel:
+*               gradient_row_sse41(rows, out, 512, hi)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+__attribute__((target("sse4.1")))
+static void gradient_row_sse41(const GradientRows &rows, uint16_t *out, int cols, uint16_t &hi) {
+	const __m128i three = _mm_set1_epi16(3);
+	const __m128i ten = _mm_set1_epi16(10);
+	__m128i vhi = _mm_set1_epi16((short) hi);
+	int x = 1;
+	for (; x + 8 <= cols - 1; x += 8) {
+		__m128i a = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) (rows.up + x + 1))), _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) (rows.up + x - 1))));
+		__m128i b = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) (rows.mid + x + 1))), _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) (rows.mid + x - 1))));
+		__m128i c = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) (rows.down + x + 1))), _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) (rows.down + x - 1))));
+		__m128i g = _mm_abs_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(a, c), three), _mm_mullo_epi16(b, ten)));
+		_mm_storeu_si128((__m128i*) (out + x), g);
+		vhi = _mm_max_epu16(vhi, g);
+	}
+	// minpos gives the smallest lane, so the largest is the smallest of the complement
+	hi = (uint16_t) ~_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(vhi, _mm_set1_epi16(-1))), 0);
+	gradient_row_tail(rows, out, x, cols, hi);
+}
+
+/** Beskrivning:  AVX2 version av en rad, sexton pixlar åt gången i 16 bitars heltal
+* Argument 1:   const GradientRows& - raderna ovanför, i och under
+* Argument 2:   uint16_t* - pekare till radens gradient
+* Argument 3:   int - bildens bredd
+* Argument 4:   uint16_t& - största värdet hittills
+* Return:       void
+* Exempel:
+*               gradient_row_avx2(rows, out, 512, hi)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+__attribute__((target("avx2")))
+static void gradient_row_avx2(const GradientRows &rows, uint16_t *out, int cols, uint16_t &hi) {
+	const __m256i three = _mm256_set1_epi16(3);
+	const __m256i ten = _mm256_set1_epi16(10);
+	__m256i vhi = _mm256_set1_epi16((short) hi);
+	int x = 1;
+	for (; x + 16 <= cols - 1; x += 16) {
+		__m256i a = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (rows.up + x + 1))), _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (rows.up + x - 1))));
+		__m256i b = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (rows.mid + x + 1))), _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (rows.mid + x - 1))));
+		__m256i c = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (rows.down + x + 1))), _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (rows.down + x - 1))));
+		__m256i g = _mm256_abs_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_add_epi16(a, c), three), _mm256_mullo_epi16(b, ten)));
+		_mm256_storeu_si256((__m256i*) (out + x), g);
+		vhi = _mm256_max_epu16(vhi, g);
+	}
+	__m128i hi128 = _mm_max_epu16(_mm256_castsi256_si128(vhi), _mm256_extracti128_si256(vhi, 1));
+	hi = (uint16_t) ~_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(hi128, _mm_set1_epi16(-1))), 0);
+	gradient_row_tail(rows, out, x, cols, hi);
+}
+#endif
+
+/** Beskrivning:  Väljer den snabbaste versionen som processorn klarar, körs en gång när programmet startar
+* Argument 1:   const char** - pekare där namnet på versionen sparas
+* Return:       GradientRowFn - funktionen för en rad
+* Exempel:
+*               select_gradient_row(&name) => gradient_row_avx2 och name = "avx2" på en processor med AVX2
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static GradientRowFn select_gradient_row(const char **name) {
+#ifdef GRADIENT_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return gradient_row_avx2;
+	}
+	if (__builtin_cpu_supports("sse4.1")) {
+		*name = "sse4.1";
+		return gradient_row_sse41;
+	}
+#endif
+	*name = "scalar";
+	return gradient_row_scalar;
+}
+
+static const char *gradient_kernel_name = "scalar";
+static const GradientRowFn gradient_row = select_gradient_row(&gradient_kernel_name);
+
+/** Beskrivning:  Namnet på den version av fused_scharr_x() som valts för processorn
+* Return:       const char* - "avx2", "sse4.1" eller "scalar"
+* Exempel:
+*               fused_scharr_x_kernel() => "avx2"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+const char* fused_scharr_x_kernel() {
+	return gradient_kernel_name;
+}
+
+/** Beskrivning:  Gradientens absolutbelopp för en rad, den första och sista kolumnen blir 0 eftersom kanterna speglas
+* Argument 1:   const uint8_t* - pekare till raden ovanför, speglad vid bildens kant
+* Argument 2:   const uint8_t* - pekare till raden
+* Argument 3:   const uint8_t* - pekare till raden under, speglad vid bildens kant
+* Argument 4:   uint16_t* - pekare där radens gradient sparas
+* Argument 5:   int - antal kolumner
+* Argument 6:   uint16_t& - största värdet hittills, uppdateras
+* Return:       void
+* Exempel:
+*               scharr_x_row(up, mid, down, out, 512, hi) => out[0] och out[511] är 0
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void scharr_x_row(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint16_t *magnitude, int cols, uint16_t &hi) {
+	if (cols <= 0)
+		return;
+	GradientRows neighbours;
+	neighbours.up = up;
+	neighbours.mid = mid;
+	neighbours.down = down;
+	magnitude[0] = 0;
+	magnitude[cols - 1] = 0;
+	if (cols > 2)
+		gradient_row(neighbours, magnitude, cols, hi);
+}
+
+/** Beskrivning:  Tabell från gradientens absolutbelopp till det normaliserade värdet i [0, 255], med samma flyttal som uttrycket
+*									255 * ((gradX - minVal) / (maxVal - minVal)) och samma avrundning som convertTo, då min alltid är 0
+* Argument 1:   uint16_t - största gradienten i bilden
+* Argument 2:   uint8_t* - pekare till tabellen, SCHARR_X_MAX + 1 element
+* Return:       void
+* Exempel:
+*               scharr_x_table(1020, table) => table[1020] = 255 och table[510] = 128
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void scharr_x_table(uint16_t hi, uint8_t *table) {
+	// A flat image gives 0 / 0, which convertTo turns into 0
+	if (hi == 0) {
+		std::fill(table, table + SCHARR_X_MAX + 1, 0);
+		return;
+	}
+	float alpha = (float) ((1.0 / hi) * 255);
+	for (int g = 0; g <= hi; g++)
+		table[g] = (uint8_t) std::min(255L, lrintf(g * alpha));
+}
+
+/** Beskrivning:  Horisontell Scharr gradient (cv::Sobel med ksize -1), absolutbelopp och normalisering till [0, 255] i två pass utan flyttal per pixel.
+*									Första passet räknar gradienten i 16 bitars heltal och håller reda på max, andra passet slår upp varje värde
+*									i en tabell med 4081 element eftersom gradienten bara kan ha så många värden. Gradienten och max är exakt samma som
+*									med cv::Sobel till CV_32F, och min är alltid 0 eftersom kanterna speglas. Tabellen räknar fram skalan i samma ordning
+*									som uttrycket 255 * ((gradX - minVal) / (maxVal - minVal)) och avrundar som convertTo, så resultatet är bitvis samma.
+*									Då min är 0 blir offseten -0 och fma eller inte i OpenCV:s convertTo ger samma avrundning
+* Argument 1:   const uint8_t* - pekare till gråskalebilden
+* Argument 2:   size_t - radlängd i byte för gråskalebilden
+* Argument 3:   uint8_t* - pekare där den normaliserade gradienten sparas
+* Argument 4:   size_t - radlängd i byte för resultatet
+* Argument 5:   uint16_t* - arbetsyta för gradienten, rows * cols element utan utfyllnad
+* Argument 6:   int - antal rader
+* Argument 7:   int - antal kolumner
+* Return:       void
+* Exempel:
+*               fused_scharr_x(blackhat.data, blackhat.step, gradX.data, gradX.step, (uint16_t*) magnitude.data, 512, 512)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void fused_scharr_x(const uint8_t *src, size_t src_step, uint8_t *dst, size_t dst_step, uint16_t *magnitude, int rows, int cols) {
+	if (rows <= 0 || cols <= 0)
+		return;
+
+	// The mirrored neighbours of the first and last column are the same pixel, the gradient is 0 there so min is always 0
+	uint16_t hi = 0;
+	for (int y = 0; y < rows; y++) {
+		const uint8_t *up = src + (y > 0 ? y - 1 : std::min(1, rows - 1)) * src_step;
+		const uint8_t *down = src + (y < rows - 1 ? y + 1 : std::max(0, rows - 2)) * src_step;
+		scharr_x_row(up, src + y * src_step, down, magnitude + (size_t) y * cols, cols, hi);
+	}
+
+	uint8_t table[SCHARR_X_MAX + 1];
+	scharr_x_table(hi, table);
+	for (int y = 0; y < rows; y++) {
+		const uint16_t *in = magnitude + (size_t) y * cols;
+		uint8_t *out = dst + y * dst_step;
+		for (int x = 0; x < cols; x++)
+			out[x] = table[in[x]];
+	}
+}
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "detection_context.hpp"
+#include "known_cars.hpp"
+#include "metrics.hpp"
+#include "ocr_pool.hpp"
+#include "pipeline.hpp"
+#include "image_batch.hpp"
+
+/** Beskrivning:  Kollar på filändelsen ifall en fil i en katalog är en bild som ska köras, stora och små bokstäver räknas lika
+* Argument 1:   const std::string& - sökväg till filen
+* Return:       bool - true för jpg, jpeg, png, bmp, tif, tiff och webp
+* Exempel:
+*               is_image_path("demo/7.JPG") => true
+*               is_image_path("samples/plates.txt") => false
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool is_image_path(const std::string &path) {
+	std::string extension = std::filesystem::path(path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+	return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp" || extension == ".tif"
+		|| extension == ".tiff" || extension == ".webp";
+}
+
+/** Beskrivning:  Konstruktor som startar en OcrPool med en Tesseract motor per arbetare. Motorerna laddas parallellt så att uppstarten inte
+*									växer med antalet arbetare
+* Argument 1:   ImageBatchConfig - konfiguration, workers 0 ger en arbetare per kärna
+* Argument 2:   KnownCars& - referens till listan över godkänt parkerade bilar
+* Return:       ImageBatch - ImageBatch objekt
+* Exempel:
+*               ImageBatch batch(config, known_cars) => batch.ok() = true när alla motorer kunde initieras
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+ImageBatch::ImageBatch(ImageBatchConfig config_in, KnownCars &known_cars_in) : known_cars(known_cars_in) {
+	this->config = config_in;
+	if (this->config.workers < 1)
+		this->config.workers = std::max(1, (int) std::thread::hardware_concurrency());
+	this->config.ocr.size = 1;
+
+	this->ocr.resize(this->config.workers, NULL);
+	std::vector<std::thread> loaders;
+	for (int i = 0; i < this->config.workers; i++)
+		loaders.emplace_back([this, i] { this->ocr[i] = new OcrPool(this->config.ocr); });
+	for (std::thread &loader : loaders)
+		loader.join();
+}
+
+/** Beskrivning:  Destruktor som stoppar alla arbetares Tesseract motorer
+* Return:       void
+* Exempel:
+*               delete batch => alla motorer är avslutade
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+ImageBatch::~ImageBatch() {
+	for (OcrPool *pool : this->ocr)
+		delete pool;
+}
+
+/** Beskrivning:  Kontrollerar att alla arbetares Tesseract motorer och en eventuell ocr modell kunde initieras
+* Return:       bool - true ifall bilderna kan köras
+* Exempel:
+*               batch.ok() => false ifall språket för Tesseract saknas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool ImageBatch::ok() const {
+	for (OcrPool *pool : this->ocr) {
+		if (!pool->ok())
+			return false;
+	}
+	return true;
+}
+
+/** Beskrivning:  Listar bilderna till arbetarna medan de körs. En katalog gås igenom rekursivt och bara bilder enligt is_image_path() tas med,
+*									en fil med en sökväg per rad läses rad för rad där tomma rader och rader som börjar med # hoppas över.
+*									Relativa sökvägar i en lista räknas från listans katalog. En enda bild körs som den är
+* Argument 1:   const std::string& - katalog, lista eller bild
+* Argument 2:   BoundedQueue<BatchJob>& - kö till arbetarna, stängs när allt är listat
+* Return:       void
+* Exempel:
+*               std::thread(&ImageBatch::list, this, "../samples", std::ref(paths)) => en BatchJob per bild i samples
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void ImageBatch::list(const std::string &input, BoundedQueue<BatchJob> &paths) {
+	long seq = 0;
+	auto push = [&](const std::string &path) {
+		BatchJob job;
+		job.path = path;
+		job.seq = seq++;
+		this->listed++;
+		return paths.push(std::move(job)); // false once run() has stopped
+	};
+
+	std::error_code error;
+	if (std::filesystem::is_directory(input, error)) {
+		std::filesystem::recursive_directory_iterator entry(input, std::filesystem::directory_options::skip_permission_denied, error);
+		for (; !error && entry != std::filesystem::recursive_directory_iterator(); entry.increment(error)) {
+			std::error_code type_error;
+			if (!entry->is_regular_file(type_error) || !is_image_path(entry->path().string()))
+				continue;
+			if (!push(entry->path().string()))
+				break;
+		}
+		if (error)
+			std::cerr << "Cannot list " << input << ": " << error.message() << std::endl;
+	} else if (is_image_path(input)) {
+		push(input);
+	} else {
+		std::ifstream file(input);
+		if (!file.is_open())
+			std::cerr << "Cannot read image list " << input << std::endl;
+		std::filesystem::path base = std::filesystem::path(input).parent_path();
+		std::string line;
+		while (std::getline(file, line)) {
+			while (!line.empty() && std::isspace((unsigned char) line.back()))
+				line.pop_back();
+			if (line.empty() || line[0] == '#')
+				continue;
+			std::filesystem::path path(line);
+			if (path.is_relative())
+				path = base / path;
+			if (!push(path.string()))
+				break;
+		}
+	}
+
+	this->listing = false;
+	paths.close();
+}
+
+/** Beskrivning:  Arbetsloopen för en arbetare, tar en bild i taget och gör allt för den med arbetarens egen arbetsyta och Tesseract motor
+* Argument 1:   int - arbetarens nummer, väljer OcrPool
+* Argument 2:   BoundedQueue<BatchJob>& - kö från listningen
+* Argument 3:   BoundedQueue<BatchJob>& - kö till den anroppande tråden i run()
+* Return:       void
+* Exempel:
+*               std::thread(&ImageBatch::work, this, 0, std::ref(paths), std::ref(results)) => körs tills allt är listat och kört eller allt stoppas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void ImageBatch::work(int worker, BoundedQueue<BatchJob> &paths, BoundedQueue<BatchJob> &results) {
+	DetectionContext detection; // Reallocates only when the image size changes
+	detection.processing_width = this->config.processing_width;
+	detection.bands = 1; // The workers already fill the cores, every image stays on its own
+	OcrPool &ocr = *this->ocr[worker];
+	BatchJob job;
+	while (!this->stopping && paths.pop(job)) {
+		auto start = std::chrono::steady_clock::now();
+		cv::Mat frame = cv::imread(job.path, this->config.luma ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+		job.read = !frame.empty();
+		if (job.read) {
+			std::vector<std::vector<cv::Point>> &candidates = locateCandidates(frame, detection);
+			job.matches = extract_ids(ocr, frame, candidates, this->known_cars);
+			for (const Match &match : job.matches) {
+				if (match.parking_valid)
+					job.parking_valid = true;
+				if (match.id_valid)
+					job.id_valid = true;
+			}
+		} else {
+			this->unreadable++;
+		}
+		job.latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		METRICS.frame.observe(job.latency_ms / 1000);
+		METRICS.frames.add();
+		if (job.id_valid)
+			this->with_plates++;
+		this->processed++;
+		if (!results.push(std::move(job)))
+			break;
+		job = BatchJob();
+	}
+}
+
+/** Beskrivning:  Startar listningen och config.workers arbetare och lämnar resultaten i den anroppande tråden när de blir klara, inte i
+*									listningens ordning. Returnerar när alla bilder är körda eller on_image returnerar false
+* Argument 1:   const std::string& - katalog, lista med en bild per rad eller en bild
+* Argument 2:   std::function<bool(BatchJob&)> - anroppas för varje körd bild, även de som inte gick att läsa, returnera false för att avbryta
+* Return:       void
+* Exempel:
+*               batch.run("archive.txt", [](BatchJob &job) { std::cout << job.path << std::endl; return true; }) => en rad per bild i listan
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void ImageBatch::run(const std::string &input, std::function<bool(BatchJob&)> on_image) {
+	BoundedQueue<BatchJob> paths(this->config.queue_size, Backpressure::BLOCK);
+	BoundedQueue<BatchJob> results(this->config.queue_size, Backpressure::BLOCK);
+	this->started = std::chrono::steady_clock::now();
+	this->listing = true;
+
+	std::thread lister(&ImageBatch::list, this, input, std::ref(paths));
+	std::vector<std::thread> workers;
+	for (int i = 0; i < this->config.workers; i++)
+		workers.emplace_back(&ImageBatch::work, this, i, std::ref(paths), std::ref(results));
+
+	/* When every worker is done there are no more results */
+	std::thread closer([&] {
+		for (std::thread &worker : workers)
+			worker.join();
+		results.close();
+	});
+
+	BatchJob job;
+	while (results.pop(job)) {
+		if (!on_image(job)) {
+			this->stopping = true;
+			paths.close();
+			results.close();
+			break;
+		}
+	}
+
+	closer.join();
+	lister.join();
+	this->elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->started).count();
+}
+
+/** Beskrivning:  Skriver en rad om hur långt körningen har kommit, anroppas från on_image medan run() pågår
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               batch.progress(std::cerr) => "Processed 12000 of 40000+ listed images (820.4 images/s), 3 unreadable, 9650 with a valid plate"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void ImageBatch::progress(std::ostream &out) {
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->started).count();
+	long processed_now = this->processed;
+	out << "Processed " << processed_now << " of " << this->listed << (this->listing ? "+" : "") << " listed images ("
+		<< processed_now / std::max(seconds, 1e-3) << " images/s), " << this->unreadable << " unreadable, " << this->with_plates
+		<< " with a valid plate" << std::endl;
+}
+
+/** Beskrivning:  Skriver en sammanfattning av hela körningen efter run()
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               batch.report(std::cout) => "Processed 2000 images in 41.2s (48.5 images/s) on 8 workers, 3 unreadable, 1620 with a valid plate"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void ImageBatch::report(std::ostream &out) {
+	out << "Processed " << this->processed << " images in " << this->elapsed_s << "s (" << this->processed / std::max(this->elapsed_s, 1e-3)
+		<< " images/s) on " << this->config.workers << " workers, " << this->unreadable << " unreadable, " << this->with_plates
+		<< " with a valid plate" << std::endl;
+}
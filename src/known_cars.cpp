@@ -0,0 +1,231 @@
+#include <chrono>
+#include <iostream>
+#include <sys/stat.h>
+#include "known_cars.hpp"
+#include "file_handler.hpp"
+
+#define EMPTY_SLOT UINT32_MAX // 36^6 packed plates never reach this value
+
+/** Beskrivning:  Packar en registreringsskylt med sex tecken från [A-Z0-9] till ett heltal i bas 36
+* Argument 1:   const char* - pekare till registreringsskylten
+* Argument 2:   size_t - antal tecken
+* Argument 3:   uint32_t& - referens där det packade värdet sparas
+* Return:       bool - false ifall strängen inte är en giltig registreringsskylt
+* Exempel:
+*               pack_plate("000001", 6, packed) => true, packed = 1
+*               pack_plate("YAH08#", 6, packed) => false
+*               pack_plate("YAH08", 5, packed) => false
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool pack_plate(const char *plate, size_t length, uint32_t &packed) {
+	if (length != PLATE_LENGTH)
+		return false;
+	packed = 0;
+	for (size_t i = 0; i < length; i++) {
+		char c = plate[i];
+		uint32_t digit;
+		if (c >= '0' && c <= '9')
+			digit = c - '0';
+		else if (c >= 'A' && c <= 'Z')
+			digit = c - 'A' + 10;
+		else
+			return false;
+		packed = packed * 36 + digit;
+	}
+	return true;
+}
+
+/** Beskrivning:  Blandar bitarna i en packad registreringsskylt så att närliggande skyltar sprids över hashtabellen
+* Argument 1:   uint32_t - packad registreringsskylt
+* Return:       uint32_t - hashvärde
+* Exempel:
+*               hash_plate(1) => ett värde där alla 32 bitar påverkats
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static inline uint32_t hash_plate(uint32_t key) {
+	// Murmur3 finaliser
+	key ^= key >> 16;
+	key *= 0x85ebca6b;
+	key ^= key >> 13;
+	key *= 0xc2b2ae35;
+	key ^= key >> 16;
+	return key;
+}
+
+/** Beskrivning:  Konstruktor som sparar sökvägen och laddar filen en första gång
+* Argument 1:   const char* - sökväg till textfil med en registreringsskylt per rad
+* Return:       KnownCars - KnownCars objekt
+* Exempel:
+*               KnownCars known_cars("known_cars.txt") => index med alla registreringsskyltar i filen
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+KnownCars::KnownCars(const char *path_in) {
+	this->path = path_in;
+	std::atomic_store(&this->table, std::shared_ptr<const Table>(new Table()));
+	this->load();
+}
+
+/** Beskrivning:  Destruktor som stoppar bevakningen av filen ifall den är igång
+* Return:       void
+* Exempel:
+*               delete known_cars => bevakningstråden är stoppad
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+KnownCars::~KnownCars() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	if (this->watcher.joinable())
+		this->watcher.join();
+}
+
+/** Beskrivning:  Läser filen och bygger en ny hashtabell med linjär sondering, som sedan byts in atomiskt. Tabellen är minst dubbelt så stor
+*									som antalet skyltar så att sonderingarna hålls korta. En fil som saknas, är tom medan listan inte är det eller
+*									ändras medan den läses är mitt i en omskrivning, och då behålls den gamla tabellen. Listan ska därför helst bytas
+*									ut atomiskt, skrivas till en temporär fil som sedan döps om
+* Return:       bool - false ifall filen inte kunde läsas, då behålls den gamla tabellen
+* Exempel:
+*               known_cars.load() => true och size() = 3 för samples/known_cars.txt
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool KnownCars::load() {
+	struct stat before, after;
+	if (stat(this->path.c_str(), &before) != 0)
+		return false; // Keep serving the old list while the file is being replaced
+	if (before.st_size == 0 && this->size() > 0)
+		return false; // Truncated by a rewrite in place, the new list is not written yet
+	FileHandler fileHandler(this->path.c_str());
+	std::vector<uint32_t> ids = fileHandler.getPackedIDs();
+	if (stat(this->path.c_str(), &after) != 0 || after.st_size != before.st_size
+			|| after.st_mtim.tv_sec != before.st_mtim.tv_sec || after.st_mtim.tv_nsec != before.st_mtim.tv_nsec)
+		return false; // Written to while it was read, the next poll tries again
+
+	std::shared_ptr<Table> next(new Table());
+	size_t capacity = 16;
+	while (capacity < ids.size() * 2)
+		capacity <<= 1;
+	next->slots.assign(capacity, EMPTY_SLOT);
+	next->mask = capacity - 1;
+	for (uint32_t id : ids) {
+		uint32_t slot = hash_plate(id) & next->mask;
+		while (next->slots[slot] != EMPTY_SLOT && next->slots[slot] != id)
+			slot = (slot + 1) & next->mask;
+		if (next->slots[slot] == EMPTY_SLOT) {
+			next->slots[slot] = id;
+			next->count++;
+		}
+	}
+
+	std::atomic_store(&this->table, std::shared_ptr<const Table>(next));
+	return true;
+}
+
+/** Beskrivning:  Slår upp en registreringsskylt i tabellen
+* Argument 1:   const std::string& - registreringsskylten, som parse_answer() lämnar den
+* Return:       bool - true ifall skylten finns i listan
+* Exempel:
+*               known_cars.contains("YAJ066") => true
+*               known_cars.contains("") => false
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool KnownCars::contains(const std::string &plate) const {
+	uint32_t id;
+	if (!pack_plate(plate.c_str(), plate.length(), id))
+		return false;
+
+	std::shared_ptr<const Table> current = std::atomic_load(&this->table);
+	if (current->slots.empty())
+		return false;
+	uint32_t slot = hash_plate(id) & current->mask;
+	while (current->slots[slot] != EMPTY_SLOT) {
+		if (current->slots[slot] == id)
+			return true;
+		slot = (slot + 1) & current->mask;
+	}
+	return false;
+}
+
+/** Beskrivning:  Antal unika registreringsskyltar i den nuvarande tabellen
+* Return:       size_t - antal skyltar
+* Exempel:
+*               known_cars.size() => 3
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+size_t KnownCars::size() const {
+	return std::atomic_load(&this->table)->count;
+}
+
+/** Beskrivning:  Startar en tråd som kontrollerar filens ändringstid och storlek med jämna mellanrum och laddar om den när den ändrats
+* Argument 1:   int - millisekunder mellan kontrollerna
+* Return:       void
+* Exempel:
+*               known_cars.watch(1000) => filen kontrolleras varje sekund
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void KnownCars::watch(int interval_ms) {
+	if (this->watcher.joinable())
+		return;
+	this->watcher = std::thread(&KnownCars::poll, this, interval_ms > 0 ? interval_ms : 1000);
+}
+
+/** Beskrivning:  Bevakningstrådens loop, se watch(). En ändring laddas först när filen har haft samma ändringstid och storlek två
+*									kontroller i rad, så att en fil som fortfarande skrivs inte läses halvfärdig
+* Argument 1:   int - millisekunder mellan kontrollerna
+* Return:       void
+* Exempel:
+*               std::thread(&KnownCars::poll, this, 1000)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void KnownCars::poll(int interval_ms) {
+	struct stat info;
+	struct timespec last_change = {0, 0};
+	off_t last_size = -1;
+	bool changed = false;		// Changed at the last check, loaded once it stays the same for one more
+	if (stat(this->path.c_str(), &info) == 0) {
+		last_change = info.st_mtim;
+		last_size = info.st_size;
+	}
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (!this->wake.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return this->stopping; })) {
+		if (stat(this->path.c_str(), &info) != 0)
+			continue;
+		if (info.st_mtim.tv_sec != last_change.tv_sec || info.st_mtim.tv_nsec != last_change.tv_nsec || info.st_size != last_size) {
+			last_change = info.st_mtim;
+			last_size = info.st_size;
+			changed = true;
+			continue;
+		}
+		if (!changed)
+			continue;
+
+		lock.unlock();
+		if (this->load()) {
+			changed = false;
+			std::cerr << "Reloaded " << this->size() << " known cars from " << this->path << std::endl;
+		} else if (info.st_size == 0) {
+			changed = false; // Kept until the list is written, the next change loads it
+		}
+		lock.lock();
+	}
+}
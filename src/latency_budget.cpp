@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <iostream>
+#include "latency_budget.hpp"
+#include "metrics.hpp"
+
+/** Beskrivning:  Konstruktor som sätter privata variabler i klassen LatencyBudget och startar med inställningarna i konfigurationen
+* Argument 1:   LatencyBudgetConfig - budget och gränser
+* Return:       LatencyBudget - LatencyBudget objekt
+* Exempel:
+*               LatencyBudget budget(config) => processingWidth() = 512, candidates() = 5, frameStride() = 1
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+LatencyBudget::LatencyBudget(LatencyBudgetConfig config_in) {
+	this->config = config_in;
+	this->config.min_width = std::max(32, this->config.min_width);
+	this->config.max_width = std::max(this->config.min_width, this->config.max_width);
+	this->config.width_step = std::max(1, this->config.width_step);
+	this->config.min_keep = std::max(1, this->config.min_keep);
+	this->config.max_keep = std::max(this->config.min_keep, this->config.max_keep);
+	this->config.max_stride = std::max(1, this->config.max_stride);
+	this->width = std::min(this->config.max_width, std::max(this->config.min_width, this->config.width));
+	this->keep = std::min(this->config.max_keep, std::max(this->config.min_keep, this->config.keep));
+	this->stride = 1;
+}
+
+/** Beskrivning:  Tar emot tiderna för en körd bildruta och justerar en inställning ifall medelvärdet ligger över budgeten eller klart under den
+* Argument 1:   double - millisekunder för hela bildrutan
+* Argument 2:   double - millisekunder för lokaliseringen
+* Argument 3:   double - millisekunder för ocr och matchning
+* Return:       void
+* Exempel:
+*               budget.observe(52.0, 20.0, 30.0)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void LatencyBudget::observe(double frame_ms_in, double locate_ms_in, double ocr_ms_in) {
+	float a = this->frames == 0 ? 1.0f : this->config.smoothing;
+	this->frame_ms = a * frame_ms_in + (1 - a) * this->frame_ms;
+	this->locate_ms = a * locate_ms_in + (1 - a) * this->locate_ms;
+	this->ocr_ms = a * ocr_ms_in + (1 - a) * this->ocr_ms;
+	this->frames++;
+	if (frame_ms_in > this->config.budget_ms)
+		this->frames_over++;
+
+	if (++this->since_adjustment < this->config.cooldown)
+		return;
+	bool changed = false;
+	if (this->frame_ms > this->config.budget_ms)
+		changed = this->degrade();
+	else if (this->frame_ms < this->config.budget_ms * this->config.headroom)
+		changed = this->upgrade();
+	if (changed) {
+		this->since_adjustment = 0;
+		this->adjustments++;
+	}
+
+	METRICS.processing_width.set(this->processingWidth());
+	METRICS.candidate_limit.set(this->candidates());
+	METRICS.frame_stride.set(this->frameStride());
+}
+
+/** Beskrivning:  Sänker den inställning som kostar mest tid ett steg, i sista hand körs färre bildrutor
+* Return:       bool - true ifall något ändrades
+* Exempel:
+*               degrade() => false när allt redan är på sin lägsta nivå
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool LatencyBudget::degrade() {
+	int current_width = this->width;
+	int current_keep = this->keep;
+	bool can_narrow = current_width > this->config.min_width;
+	bool can_drop = current_keep > this->config.min_keep;
+
+	// Locating scales with the number of pixels, OCR with the number of candidates
+	if (can_narrow && (this->locate_ms >= this->ocr_ms || !can_drop)) {
+		this->width = std::max(this->config.min_width, current_width - this->config.width_step);
+		return true;
+	}
+	if (can_drop) {
+		this->keep = current_keep - 1;
+		return true;
+	}
+	if (this->stride < this->config.max_stride) {
+		this->stride++;
+		return true;
+	}
+	return false;
+}
+
+/** Beskrivning:  Höjer kvaliteten ett steg: först körs fler bildrutor, sedan fler kandidater och sist högre upplösning
+* Return:       bool - true ifall något ändrades
+* Exempel:
+*               upgrade() => false när allt redan är på sin högsta nivå
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool LatencyBudget::upgrade() {
+	if (this->stride > 1) {
+		this->stride--;
+		return true;
+	}
+	if (this->keep < this->config.max_keep) {
+		this->keep++;
+		return true;
+	}
+	int current_width = this->width;
+	if (current_width < this->config.max_width) {
+		this->width = std::min(this->config.max_width, current_width + this->config.width_step);
+		return true;
+	}
+	return false;
+}
+
+/** Beskrivning:  Skriver ut hur budgeten hölls och var inställningarna hamnade
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               budget.report(std::cout) => "Latency budget 40ms: 31.2ms average, 12 of 900 frames over, 6 adjustments, width 448, 4 candidates, every 1 frame"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void LatencyBudget::report(std::ostream &out) {
+	out << "Latency budget " << this->config.budget_ms << "ms: " << this->frame_ms << "ms average, "
+		<< this->frames_over << " of " << this->frames << " frames over, "
+		<< this->adjustments << " adjustments, width " << this->processingWidth() << ", "
+		<< this->candidates() << " candidates, every " << this->frameStride() << " frame" << std::endl;
+}
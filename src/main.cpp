@@ -1,105 +1,246 @@
 #include <stdio.h>
 #include <iostream>
-#include <opencv2/opencv.hpp>
+#include <sstream>
 #include <vector>
-#include <main.hpp>
-#include <tesseract/baseapi.h>
-#include <leptonica/allheaders.h>
 #include <chrono>
-#include "file_handler.hpp"
-
-#define MIN_AR 1        // Minimum aspect ratio
-#define MAX_AR 6        // Maximum aspect ratio
-#define KEEP 5          // Limit the number of license plates
-#define RECT_DIFF 2000  // Set the difference between contour and rectangle
-
-int debug_imgs_cnt = 0;
+#include "anpr.hpp"
 
 struct {
-	bool debug = false;
+	bool pipeline = false;
+	PipelineConfig pipeline_config;
+	EngineConfig engine;
+	SamplingConfig sampling;
+	bool luma = false;
+	bool headless = false;
+	std::string output;
+	EventFormat format = EventFormat::JSON;
+	int metrics_port = 0;
+	std::string metrics_file;
+	int metrics_interval = 5000;
+	std::string streams;
+	PlateLogConfig plate_log;
+	int64_t start_us = 0;		// Capture time of the first frame of the video, 0 when unknown
+	bool batch = false;
+	ImageBatchConfig batch_config;
+	int batch_progress = 10;	// Seconds between progress lines in batch mode
+	std::string shm;		// Frames from a capture process in shared memory instead of a video
+	int shm_timeout = 5000;		// Milliseconds without a new frame before the producer counts as gone, 0 to wait forever
 } FLAGS;
 
-struct {
-	int frame_w = 0;
-	int frame_h = 0;
-	float ratio_w = 0.0f;
-	float ratio_h = 0.0f;
-} FRAME_METADATA;
-
-struct Match {
-	cv::Rect rectangle;
-	std::string id;
-	bool id_valid;
-	bool parking_valid;
-};
-
-struct {
-	bool parking_valid;
-	bool id_valid;
-} anprResult;
-
-// Macros
-void debug_img(const char* name, cv::Mat &img);
-std::vector<Match> extract_ids(tesseract::TessBaseAPI *api, cv::Mat &frame, std::vector<std::vector<cv::Point>> &candidates, std::vector<std::string> &known_cars);
-std::vector<std::string> _split(std::string s, std::string delimiter, bool avoid_double);
-void drawMatches(cv::Mat &frame, std::vector<Match> &matches, std::vector<std::vector<cv::Point>> &candidates);
-
-/** Beskrivning:  Funktion som anroppar externt api för ocr (Optical character recognition) algirithmen
-* Argument 1:   tesseract::TessBaseAPI* - pekare till Tesseract api
-* Argument 2:   cv::Mat - bild att köra ocr algoritmen på
-* Argument 3:	  std::string& - referens till den sträng där svaret ska sparas, hittas ingen text sparas ingen text
-* Return:       void
+/** Beskrivning:  Kör alla strömmar i konfigurationen FLAGS.streams i samma process med MultiStream, istället för en enda video. Varje ström får ett eget fönster
+*									och raderna från EventWriter märks med strömmens namn
+* Argument 1:   Engine& - referens till motorn vars Tesseract motorer och debug bilder alla strömmar delar
+* Argument 2:   EventWriter* - pekare till utdata för varje bildruta, eller NULL
+* Argument 3:   PlateLog* - pekare till den beständiga loggen över matchningar, eller NULL
+* Argument 4:   std::ostream& - ström för meddelanden
+* Return:       int - status kod för programmet
 * Exempel:
-*               run_ocr(api, crop, answer) => void - svaret sparas i answer
+*               run_streams(engine, events, plate_log, console) => 0 när alla strömmar är slut eller q trycks
 *
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
+* By:           agent
+* Date:         2026-10-17
 **/
-void run_ocr(tesseract::TessBaseAPI *api, cv::Mat input, std::string &answer) {
-	char *outText;
+int run_streams(Engine &engine, EventWriter *events, PlateLog *plate_log, std::ostream &console) {
+	std::vector<StreamConfig> configs;
+	if (!read_stream_config(FLAGS.streams, configs)) {
+		std::cerr << "Cannot read streams from " << FLAGS.streams << std::endl;
+		return 1;
+	}
 
-	// Pass image data to tesseract
-	api->SetImage((uchar*)input.data, input.size().width, input.size().height, input.channels(), input.step1());
+	MultiStreamConfig config;
+	config.pipeline		= FLAGS.pipeline_config;
+	config.track		= FLAGS.engine.track;
+	config.tracker		= FLAGS.engine.tracker;
+	config.motion		= FLAGS.engine.motion;
+	config.motion_config	= FLAGS.engine.motion_config;
+	config.sampling		= FLAGS.sampling;
+	config.luma		= FLAGS.luma;
+	config.reload_interval	= FLAGS.engine.reload_interval;
+	MultiStream streams(config, engine.ocrPool(), engine.debugImages());
+	for (StreamConfig &stream : configs) {
+		if (!streams.add(stream))
+			console << "Cannot open stream " << stream.name << " (" << stream.source << ")" << std::endl;
+	}
+	if (streams.size() == 0) {
+		console << "No stream could be opened" << std::endl;
+		return 1;
+	}
+	console << "Running " << streams.size() << " streams on " << std::max(1, FLAGS.pipeline_config.detect_threads) << " workers" << std::endl;
+
+	auto run_start = std::chrono::steady_clock::now();
+	long frames = 0;
+	streams.run([&](Stream &stream, FrameJob &job) {
+		frames++;
+		if (events != NULL || plate_log != NULL) {
+			FrameEvent event;
+			event.stream		= stream.config.name;
+			event.frame		= job.seq;
+			event.position_ms	= job.position_ms;
+			event.latency_ms	= std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.start).count();
+			event.parking_valid	= job.parking_valid;
+			event.id_valid		= job.id_valid;
+			if (events != NULL)
+				events->write(event, job.matches);
+			if (plate_log != NULL)
+				plate_log->write(event, job.matches);
+		}
+		if (FLAGS.headless)
+			return true;
 
-	// Get OCR result
-	outText = api->GetUTF8Text();
-	answer = outText;
+		drawMatches(job.frame, job.matches, job.candidates);
+		cv::imshow(stream.config.name, job.frame);
 
-	// Release memory
-	delete [] outText;
+		// One window per stream, only poll the keyboard so no stream waits for another
+		if (cv::waitKey(1) == 'q') {
+			std::cout << "Sigkill received, exiting now..." << std::endl;
+			return false;
+		}
+		return true;
+	});
+	if (!FLAGS.headless)
+		cv::destroyAllWindows();
+
+	float seconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - run_start).count() / 1000.0f;
+	console << "Processed " << frames << " frames from " << streams.size() << " streams in " << seconds << "s (" << frames / seconds << " fps)" << std::endl;
+	streams.report(console);
+	return 0;
 }
 
-/** Beskrivning:  Knutpunkt för hela anpr algoritmen, alla delar i algirithmen anroppas från denna funktion
-* Argument 1:   tesseract::TessBaseAPI* - pekare till Tesseract api
-* Argument 2:   cv::Mat& - referens till en bild att köra ocr på
-* Argument 3:	  std::vector<std::string>& - referens till en lista av godkänt parkerade bilar
-* Return:       void
+/** Beskrivning:  Kör alla bilder i en katalog eller lista med ImageBatch istället för en video. Varje bild skrivs med EventWriter märkt med
+*									sin sökväg när den är klar, och en rad om hur långt körningen kommit skrivs var FLAGS.batch_progress sekund
+* Argument 1:   const std::string& - katalog, fil med en bild per rad eller en bild
+* Argument 2:   EventWriter* - pekare till utdata för varje bild, eller NULL
+* Argument 3:   PlateLog* - pekare till den beständiga loggen över matchningar, eller NULL. Indata blir strömmens namn och bildens nummer i listningen bildrutan
+* Argument 4:   std::ostream& - ström för meddelanden
+* Return:       int - status kod för programmet
 * Exempel:
-*               anpr(api, frame, known_cars) => eventuella registreringsskyltar markeras med en rektangel på bilden i argument 2
+*               run_batch("../samples", events, NULL, console) => 0 när alla bilder är körda
 *
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
+* By:           agent
+* Date:         2026-10-17
 **/
-void anpr(tesseract::TessBaseAPI *api, cv::Mat &image, std::vector<std::string> &known_cars) {
-	std::vector<std::vector<cv::Point>> candidates = locateCandidates(image);
-	std::vector<Match> matches = extract_ids(api, image, candidates, known_cars);
-	drawMatches(image, matches, candidates);
-	debug_img("done", image);
-	anprResult.parking_valid	= false;
-	anprResult.id_valid		= false;
-	for (struct Match match : matches) {
-		if (match.parking_valid)
-			anprResult.parking_valid = true;
-		if (match.id_valid)
-			anprResult.id_valid = true;
+int run_batch(const std::string &input, EventWriter *events, PlateLog *plate_log, std::ostream &console) {
+	KnownCars known_cars(FLAGS.engine.known_cars.c_str());
+	ImageBatchConfig config = FLAGS.batch_config;
+	config.luma		= FLAGS.luma;
+	config.processing_width	= FLAGS.engine.processing_width;
+	config.ocr		= FLAGS.engine.ocr;
+	ImageBatch batch(config, known_cars);
+	if (!batch.ok()) {
+		fprintf(stderr, "Could not initialize tesseract or the ocr model.\n");
+		return 1;
 	}
+	console << "Loaded " << known_cars.size() << " known cars" << std::endl;
+
+	auto last_progress = std::chrono::steady_clock::now();
+	batch.run(input, [&](BatchJob &job) {
+		if (!job.read) {
+			std::cerr << "Cannot read " << job.path << std::endl;
+		} else if (events != NULL || plate_log != NULL) {
+			FrameEvent event;
+			event.stream		= input;
+			event.image		= job.path;
+			event.frame		= job.seq;
+			event.latency_ms	= job.latency_ms;
+			event.parking_valid	= job.parking_valid;
+			event.id_valid		= job.id_valid;
+			if (events != NULL)
+				events->write(event, job.matches);
+			if (plate_log != NULL)
+				plate_log->write(event, job.matches);
+		}
+		if (std::chrono::steady_clock::now() - last_progress >= std::chrono::seconds(FLAGS.batch_progress)) {
+			batch.progress(console);
+			last_progress = std::chrono::steady_clock::now();
+		}
+		return true;
+	});
+	batch.report(console);
+	return 0;
 }
 
-/** Beskrivning:  Startpunkten (entrypoint) för hela programmet och där stor del av logik ligger, här initieras tesseract api, video ström öppnas, och anpr() anroppas.
+/** Beskrivning:  Kör anpr på bildrutor som en fångstprocess lämnar i ringbufferten FLAGS.shm i delat minne. Varje bildruta körs där den ligger
+*									utan att kopieras, och är den nyaste som finns när den förra är klar. Bildrutor som hinner skrivas över räknas
+* Argument 1:   Engine& - referens till motorn
+* Argument 2:   EventWriter* - pekare till utdata för varje bildruta, eller NULL
+* Argument 3:   PlateLog* - pekare till den beständiga loggen över matchningar, eller NULL
+* Argument 4:   std::ostream& - ström för meddelanden
+* Return:       int - status kod för programmet
+* Exempel:
+*               run_shm(engine, events, NULL, console) => 0 när producenten stänger ringen eller q trycks
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int run_shm(Engine &engine, EventWriter *events, PlateLog *plate_log, std::ostream &console) {
+	ShmSource source(FLAGS.shm, FLAGS.luma, FLAGS.shm_timeout);
+	if (!source.ok()) {
+		console << "Cannot open shared memory " << shm_object_name(FLAGS.shm) << ", is the producer running?" << std::endl;
+		return 1;
+	}
+
+	auto run_start = std::chrono::steady_clock::now();
+	long frames = 0;
+	cv::Mat frame, shown;
+	while (source.read(frame)) {
+		auto start = std::chrono::steady_clock::now();
+		std::vector<Match> matches = engine.process(frame, (long) source.frameNumber());
+		frames++;
+		if (events != NULL || plate_log != NULL) {
+			FrameEvent event;
+			event.frame		= source.frameNumber();
+			event.position_ms	= source.timestampUs() / 1000.0;
+			event.capture_us	= source.timestampUs();
+			event.latency_ms	= std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			for (const Match &match : matches) {
+				if (match.parking_valid)
+					event.parking_valid = true;
+				if (match.id_valid)
+					event.id_valid = true;
+			}
+			if (events != NULL)
+				events->write(event, matches);
+			if (plate_log != NULL)
+				plate_log->write(event, matches);
+		}
+		if (FLAGS.headless)
+			continue;
+
+		// Drawn on a copy, the slot belongs to the producer again after release()
+		frame.copyTo(shown);
+		source.release();
+		drawMatches(shown, matches, engine.candidates());
+		cv::imshow("Frame", shown);
+		if (cv::waitKey(1) == 'q') {
+			std::cout << "Sigkill received, exiting now..." << std::endl;
+			break;
+		}
+	}
+	if (!FLAGS.headless)
+		cv::destroyAllWindows();
+
+	float seconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - run_start).count() / 1000.0f;
+	console << "Processed " << frames << " frames from shared memory in " << seconds << "s (" << frames / seconds << " fps)" << std::endl;
+	source.report(console);
+	return 0;
+}
+
+/** Beskrivning:  Startpunkten (entrypoint) för hela programmet och där stor del av logik ligger, här skapas Engine, video ström öppnas, och Engine::process() anroppas.
 *									Funktionen kör ANPR och skriver resultat i kommandotolken samt på en videoström i ett nytt fönster.
 * Argument 1:   int - antal argument som skrivs i terminalen
 * Argument 2:   char** - pekare till flera pekare, en för varje argument i kommando tolken när programmet startas.
-*												 Första argumentet i kommandotolken ska vara sökväg till videoströmm, andra argumentet till en lista av godkänt parkerade bilar
+*												 Första argumentet i kommandotolken ska vara sökväg till videoströmm, andra argumentet till en lista av godkänt parkerade bilar,
+*												 utom med --streams=fil där alla strömmar och listor står i filen. Med --batch är första argumentet en katalog
+*												 eller en fil med en bild per rad och listan över godkänt parkerade bilar valfri. Med --shm=namn läses
+*												 bildrutorna från en fångstprocess i delat minne och första argumentet är listan över godkänt parkerade bilar.
+*												 Därefter valfria flaggor: --debug, --debug-format=jpeg|png|raw, --debug-stages=steg,steg, --debug-every=N,
+*												 --debug-misreads, --debug-queue=N, --pipeline, --queue=N, --detect-threads=N, --backpressure=block|drop,
+*												 --ocr-threads=N, --lang=språk, --no-warmup, --track, --reverify=N, --motion, --motion-threshold=N, --motion-min=F,
+*												 --reload-interval=MS, --headless, --output=fil, --format=json|csv, --metrics-port=N, --metrics-file=fil,
+*												 --metrics-interval=MS, --budget=MS, --width=N, --bands=N, --ocr-model=fil, --ocr-confidence=F,
+*												 --ocr-mode=crop|frame|montage, --streams=fil, --sample=all|stride|fps|adaptive, --sample-stride=N,
+*												 --sample-fps=F, --sample-active-fps=F, --sample-hold=S, --luma, --plate-log=katalog,
+*												 --plate-log-valid-only, --start-time=tid, --batch, --batch-workers=N, --batch-progress=S, --shm=namn, --shm-timeout=MS
 * Return:       int - status kod för programmet
 * Exempel:
 *               main(argc, argv) => 0 ifall programmet inte stöter på problem, annars returneras annat nummer
@@ -109,456 +250,394 @@ void anpr(tesseract::TessBaseAPI *api, cv::Mat &image, std::vector<std::string>
 **/
 int main(int argc, char** argv )
 {
-	/* init tesseract */
-	tesseract::TessBaseAPI *api = new tesseract::TessBaseAPI();
-	if (api->Init(NULL, "swe")) {
-		fprintf(stderr, "Could not initialize tesseract.\n");
-		exit(1);
+	std::vector<const char*> positional;
+	for (int i = 1; i < argc; i++) {
+		const char *value;
+		if (strcmp(argv[i], "--debug") == 0) {
+			FLAGS.engine.debug = true;
+			std::cerr << "Debug mode is on, will output debug files" << std::endl;
+		} else if ((value = flag_value(argv[i], "--debug-format="))) {
+			if (strcmp(value, "jpeg") == 0) {
+				FLAGS.engine.debug_config.format = DebugFormat::JPEG;
+			} else if (strcmp(value, "png") == 0) {
+				FLAGS.engine.debug_config.format = DebugFormat::PNG;
+			} else if (strcmp(value, "raw") == 0) {
+				FLAGS.engine.debug_config.format = DebugFormat::RAW;
+			} else {
+				std::cerr << "Unknown debug image format: " << value << std::endl;
+			}
+		} else if ((value = flag_value(argv[i], "--debug-stages="))) {
+			std::stringstream stages(value);
+			std::string stage;
+			while (std::getline(stages, stage, ',')) {
+				if (!stage.empty())
+					FLAGS.engine.debug_config.stages.push_back(stage);
+			}
+		} else if ((value = flag_value(argv[i], "--debug-every="))) {
+			FLAGS.engine.debug_config.every = std::max(1, atoi(value));
+		} else if (strcmp(argv[i], "--debug-misreads") == 0) {
+			FLAGS.engine.debug_config.misreads = true;
+		} else if ((value = flag_value(argv[i], "--debug-queue="))) {
+			FLAGS.engine.debug_config.queue_size = std::max(1, atoi(value));
+		} else if (strcmp(argv[i], "--pipeline") == 0) {
+			FLAGS.pipeline = true;
+		} else if ((value = flag_value(argv[i], "--queue="))) {
+			FLAGS.pipeline_config.queue_size = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--detect-threads="))) {
+			FLAGS.pipeline_config.detect_threads = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--ocr-threads="))) {
+			FLAGS.engine.ocr.size = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--lang="))) {
+			FLAGS.engine.ocr.language = value;
+		} else if ((value = flag_value(argv[i], "--ocr-mode="))) {
+			if (strcmp(value, "crop") == 0) {
+				FLAGS.engine.ocr.mode = OcrMode::CROP;
+			} else if (strcmp(value, "frame") == 0) {
+				FLAGS.engine.ocr.mode = OcrMode::FRAME;
+			} else if (strcmp(value, "montage") == 0) {
+				FLAGS.engine.ocr.mode = OcrMode::MONTAGE;
+			} else {
+				std::cerr << "Unknown ocr mode: " << value << std::endl;
+			}
+		} else if ((value = flag_value(argv[i], "--ocr-model="))) {
+			FLAGS.engine.ocr.model = value;
+		} else if ((value = flag_value(argv[i], "--ocr-confidence="))) {
+			FLAGS.engine.ocr.min_confidence = atof(value);
+		} else if (strcmp(argv[i], "--no-warmup") == 0) {
+			FLAGS.engine.ocr.warmup = false;
+		} else if (strcmp(argv[i], "--track") == 0) {
+			FLAGS.engine.track = true;
+		} else if ((value = flag_value(argv[i], "--reverify="))) {
+			FLAGS.engine.tracker.reverify_interval = std::max(1, atoi(value));
+		} else if (strcmp(argv[i], "--motion") == 0) {
+			FLAGS.engine.motion = true;
+		} else if ((value = flag_value(argv[i], "--motion-threshold="))) {
+			FLAGS.engine.motion_config.pixel_threshold = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--motion-min="))) {
+			FLAGS.engine.motion_config.min_changed = atof(value);
+		} else if ((value = flag_value(argv[i], "--reload-interval="))) {
+			FLAGS.engine.reload_interval = std::max(0, atoi(value));
+		} else if (strcmp(argv[i], "--headless") == 0) {
+			FLAGS.headless = true;
+		} else if ((value = flag_value(argv[i], "--output="))) {
+			FLAGS.output = value;
+		} else if ((value = flag_value(argv[i], "--format="))) {
+			if (strcmp(value, "csv") == 0) {
+				FLAGS.format = EventFormat::CSV;
+			} else if (strcmp(value, "json") == 0) {
+				FLAGS.format = EventFormat::JSON;
+			} else {
+				std::cerr << "Unknown output format: " << value << std::endl;
+			}
+		} else if ((value = flag_value(argv[i], "--metrics-port="))) {
+			FLAGS.metrics_port = std::max(0, atoi(value));
+		} else if ((value = flag_value(argv[i], "--metrics-file="))) {
+			FLAGS.metrics_file = value;
+		} else if ((value = flag_value(argv[i], "--metrics-interval="))) {
+			FLAGS.metrics_interval = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--budget="))) {
+			FLAGS.engine.budget = true;
+			FLAGS.engine.budget_config.budget_ms = std::max(1.0, atof(value));
+		} else if ((value = flag_value(argv[i], "--width="))) {
+			FLAGS.engine.processing_width = std::max(32, atoi(value));
+			FLAGS.engine.budget_config.width = FLAGS.engine.processing_width;
+			FLAGS.pipeline_config.processing_width = FLAGS.engine.processing_width;
+		} else if ((value = flag_value(argv[i], "--bands="))) {
+			FLAGS.engine.bands = std::max(0, atoi(value));
+			FLAGS.pipeline_config.bands = FLAGS.engine.bands;
+		} else if ((value = flag_value(argv[i], "--backpressure="))) {
+			if (strcmp(value, "drop") == 0) {
+				FLAGS.pipeline_config.backpressure = Backpressure::DROP_OLDEST;
+			} else if (strcmp(value, "block") == 0) {
+				FLAGS.pipeline_config.backpressure = Backpressure::BLOCK;
+			} else {
+				std::cerr << "Unknown backpressure policy: " << value << std::endl;
+			}
+		} else if ((value = flag_value(argv[i], "--sample="))) {
+			if (strcmp(value, "all") == 0) {
+				FLAGS.sampling.mode = SamplingMode::ALL;
+			} else if (strcmp(value, "stride") == 0) {
+				FLAGS.sampling.mode = SamplingMode::STRIDE;
+			} else if (strcmp(value, "fps") == 0) {
+				FLAGS.sampling.mode = SamplingMode::FPS;
+			} else if (strcmp(value, "adaptive") == 0) {
+				FLAGS.sampling.mode = SamplingMode::ADAPTIVE;
+			} else {
+				std::cerr << "Unknown sampling mode: " << value << std::endl;
+			}
+		} else if ((value = flag_value(argv[i], "--sample-stride="))) {
+			FLAGS.sampling.stride = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--sample-fps="))) {
+			FLAGS.sampling.fps = std::max(0.01, atof(value));
+		} else if ((value = flag_value(argv[i], "--sample-active-fps="))) {
+			FLAGS.sampling.active_fps = std::max(0.0, atof(value));
+		} else if ((value = flag_value(argv[i], "--sample-hold="))) {
+			FLAGS.sampling.hold_seconds = std::max(0.0, atof(value));
+		} else if (strcmp(argv[i], "--luma") == 0) {
+			FLAGS.luma = true;
+		} else if ((value = flag_value(argv[i], "--plate-log="))) {
+			FLAGS.plate_log.directory = value;
+		} else if (strcmp(argv[i], "--plate-log-valid-only") == 0) {
+			FLAGS.plate_log.valid_only = true;
+		} else if ((value = flag_value(argv[i], "--start-time="))) {
+			if (!parse_time(value, FLAGS.start_us))
+				std::cerr << "Unknown time: " << value << std::endl;
+		} else if ((value = flag_value(argv[i], "--streams="))) {
+			FLAGS.streams = value;
+		} else if ((value = flag_value(argv[i], "--shm="))) {
+			FLAGS.shm = value;
+		} else if ((value = flag_value(argv[i], "--shm-timeout="))) {
+			FLAGS.shm_timeout = std::max(0, atoi(value));
+		} else if (strcmp(argv[i], "--batch") == 0) {
+			FLAGS.batch = true;
+		} else if ((value = flag_value(argv[i], "--batch-workers="))) {
+			FLAGS.batch_config.workers = std::max(0, atoi(value));
+		} else if ((value = flag_value(argv[i], "--batch-progress="))) {
+			FLAGS.batch_progress = std::max(1, atoi(value));
+		} else if (strncmp(argv[i], "--", 2) != 0) {
+			positional.push_back(argv[i]);
+		} else {
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
+		}
 	}
-
-	if (argc < 2) {
-		std::cout << "Please pass video url" << std::endl;
-		api->End();
-		delete api;
+	/* The shared memory name takes the place of the video url */
+	if (!FLAGS.shm.empty())
+		positional.insert(positional.begin(), FLAGS.shm.c_str());
+	if ((FLAGS.streams.empty() || FLAGS.batch) && positional.size() < 1) {
+		std::cout << (FLAGS.batch ? "Please pass a directory or list of images" : "Please pass video url") << std::endl;
 		exit(1);
 	}
-	if (argc < 3) {
+	if (FLAGS.streams.empty() && !FLAGS.batch && positional.size() < 2) {
 		std::cout << "Please pass list of known cars" << std::endl;
-		api->End();
-		delete api;
 		exit(1);
 	}
-	if (argc > 3) {
-		if (strcmp(argv[3], "--debug")) {
-			FLAGS.debug = true;
-			std::cout << "Debug mode is on, will output debug files" << std::endl;
+
+	if (FLAGS.streams.empty() && positional.size() >= 2)
+		FLAGS.engine.known_cars = positional[1];
+
+	/* Stills have no window to show, the results are the output */
+	if (FLAGS.batch)
+		FLAGS.headless = true;
+
+	/* Keep stdout free for the results when they are written there */
+	std::ostream &console = FLAGS.headless ? std::cerr : std::cout;
+
+	/* Structured output of every frame, used in headless mode */
+	EventWriter *events = NULL;
+	if (FLAGS.headless || !FLAGS.output.empty()) {
+		EventTag tag = FLAGS.batch ? EventTag::IMAGE : !FLAGS.streams.empty() ? EventTag::STREAM : EventTag::NONE;
+		events = new EventWriter(FLAGS.output.empty() ? "-" : FLAGS.output, FLAGS.format, tag);
+		if (!events->ok()) {
+			std::cerr << "Cannot open output " << FLAGS.output << std::endl;
+			exit(1);
+		}
+	}
+
+	/* Every match kept on disk, indexed by plate and time for anpr_query */
+	PlateLog *plate_log = NULL;
+	if (!FLAGS.plate_log.directory.empty()) {
+		plate_log = new PlateLog(FLAGS.plate_log);
+		if (!plate_log->ok()) {
+			std::cerr << "Cannot open plate log " << FLAGS.plate_log.directory << std::endl;
+			exit(1);
 		}
 	}
 
-	/* Read ok parked cars */
-	FileHandler fileHandler(argv[2]);
-	std::vector<std::string> known_cars = fileHandler.getIDs();
+	/* Prometheus metrics over http and/or as a file for the node exporter textfile collector */
+	MetricsExporter *metrics = NULL;
+	if (FLAGS.metrics_port > 0 || !FLAGS.metrics_file.empty()) {
+		metrics = new MetricsExporter(FLAGS.metrics_port, FLAGS.metrics_file, FLAGS.metrics_interval);
+		if (!metrics->ok())
+			std::cerr << "Cannot serve metrics on port " << FLAGS.metrics_port << std::endl;
+	}
+
+	/* Folders of stills on workers with their own ocr engines, the engine below is not needed */
+	if (FLAGS.batch) {
+		int status = run_batch(positional[0], events, plate_log, console);
+		if (events != NULL)
+			delete events;
+		if (plate_log != NULL)
+			delete plate_log;
+		if (metrics != NULL)
+			delete metrics;
+		return status;
+	}
+
+	/* Tesseract engines, known cars and everything else the detector keeps between frames */
+	Engine *engine = new Engine(FLAGS.engine);
+	if (!engine->ok()) {
+		fprintf(stderr, "Could not initialize tesseract or the ocr model.\n");
+		delete engine;
+		exit(1);
+	}
+
+	/* Several cameras sharing the ocr engines and workers */
+	if (!FLAGS.streams.empty()) {
+		int status = run_streams(*engine, events, plate_log, console);
+		engine->report(console);
+		if (events != NULL)
+			delete events;
+		if (plate_log != NULL)
+			delete plate_log;
+		if (metrics != NULL)
+			delete metrics;
+		delete engine;
+		return status;
+	}
+	console << "Loaded " << engine->knownCars().size() << " known cars" << std::endl;
+
+	/* Frames a capture process already decoded, read where they lie in shared memory */
+	if (!FLAGS.shm.empty()) {
+		int status = run_shm(*engine, events, plate_log, console);
+		engine->report(console);
+		if (events != NULL)
+			delete events;
+		if (plate_log != NULL)
+			delete plate_log;
+		if (metrics != NULL)
+			delete metrics;
+		delete engine;
+		return status;
+	}
 
 	/* Process video */
 
-	cv::VideoCapture cap(argv[1]);
+	cv::VideoCapture cap(positional[0]);
+	FrameSource source(cap, FLAGS.sampling, FLAGS.luma);
 	cv::Mat frame;
 	auto start = std::chrono::steady_clock::now();
 	auto end = start;
+	auto run_start = start;
 	int number_of_test = 0;
 	int valid_tests = 0;
 
 	if (!cap.isOpened()) {
-		std::cout << "Cannot open video stream or file" << std::endl;
+		console << "Cannot open video stream or file" << std::endl;
 	} else {
-		std::cout << "fps: " << cap.get(cv::CAP_PROP_FPS);
-		std::cout << "frame count: " << cap.get(cv::CAP_PROP_FRAME_COUNT);
+		console << "fps: " << cap.get(cv::CAP_PROP_FPS);
+		console << "frame count: " << cap.get(cv::CAP_PROP_FRAME_COUNT) << std::endl;
+	}
+
+	if (FLAGS.pipeline && cap.isOpened()) {
+		/* Staged pipeline, decode, detection and ocr run on their own threads while this thread renders */
+		Pipeline pipeline(FLAGS.pipeline_config, engine->ocrPool(), engine->knownCars(), engine->plateTracker(), engine->motionGate(),
+			engine->latencyBudget(), engine->debugImages());
+		pipeline.run(source, [&](FrameJob &job) {
+			if (job.id_valid)
+				valid_tests++;
+			number_of_test++;
+			end = std::chrono::steady_clock::now();
+
+			if (events != NULL || plate_log != NULL) {
+				FrameEvent event;
+				event.frame		= job.seq;
+				event.position_ms	= job.position_ms;
+				event.capture_us	= FLAGS.start_us != 0 ? FLAGS.start_us + (int64_t) (job.position_ms * 1000) : 0;
+				event.latency_ms	= std::chrono::duration<double, std::milli>(end - job.start).count();
+				event.parking_valid	= job.parking_valid;
+				event.id_valid		= job.id_valid;
+				if (events != NULL)
+					events->write(event, job.matches);
+				if (plate_log != NULL)
+					plate_log->write(event, job.matches);
+			}
+			if (FLAGS.headless)
+				return true;
+
+			drawMatches(job.frame, job.matches, job.candidates);
+			cv::imshow("Frame", job.frame);
+			std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end - job.start).count() << "ms per frame" << std::endl;
+
+			// wait 20ms or until q is pressed, if q is pressed, stop the pipeline
+			if (cv::waitKey(20 * (job.parking_valid ? 10 : 1)) == 'q') {
+				std::cout << "Sigkill received, exiting now..." << std::endl;
+				return false;
+			}
+			return true;
+		});
+		if (pipeline.framesDropped() > 0)
+			console << "Dropped " << pipeline.framesDropped() << " of " << pipeline.framesRead() << " frames" << std::endl;
 	}
 
-	/* Read every frame until the end */
-	while (cap.isOpened()){
+	/* Read the sampled frames until the end */
+	LatencyBudget *budget = engine->latencyBudget();
+	while (!FLAGS.pipeline && cap.isOpened()){
 		/* Capture time point */
 		start = std::chrono::steady_clock::now();
 
 		/* Get and handle frame */
-		if (cap.read(frame)) {
+		std::vector<Match> matches;
+		bool parking_valid = false;
+		bool id_valid = false;
+		/* Frames left out by the sampling or the latency budget are grabbed without being retrieved */
+		if (source.read(frame, budget != NULL ? budget->frameStride() : 1)) {
 			if (frame.empty()) {
 				std::cerr << "Error: blank frame grabbed" << std::endl;
 				continue;
 			}
-			anpr(api, frame, known_cars);
-			if (anprResult.id_valid)
+			matches = engine->process(frame);
+			for (const Match &match : matches) {
+				if (match.parking_valid)
+					parking_valid = true;
+				if (match.id_valid)
+					id_valid = true;
+			}
+			source.observe(id_valid);
+			if (!FLAGS.headless)
+				drawMatches(frame, matches, engine->candidates());
+			if (id_valid)
 				valid_tests++;
 			number_of_test++;
-			cv::imshow("Frame", frame);
+			if (!FLAGS.headless)
+				cv::imshow("Frame", frame);
 		} else {
-			std::cout << "Stream is closed or video camera is disconnected" << std::endl;
+			console << "Stream is closed or video camera is disconnected" << std::endl;
 			break;
 		}
 
 		/* Capture time point */
 		end = std::chrono::steady_clock::now();
 
+		if (events != NULL || plate_log != NULL) {
+			FrameEvent event;
+			event.frame		= number_of_test - 1;
+			event.position_ms	= source.positionMs();
+			event.capture_us	= FLAGS.start_us != 0 ? FLAGS.start_us + (int64_t) (event.position_ms * 1000) : 0;
+			event.latency_ms	= std::chrono::duration<double, std::milli>(end - start).count();
+			event.parking_valid	= parking_valid;
+			event.id_valid		= id_valid;
+			if (events != NULL)
+				events->write(event, matches);
+			if (plate_log != NULL)
+				plate_log->write(event, matches);
+		}
+		if (FLAGS.headless)
+			continue; // No window and no waiting, run at full decode speed
+
 		std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms per frame" << std::endl;
 
 		// wait 20ms or until q is pressed, if q is pressed, break
-		if (cv::waitKey(20 * (anprResult.parking_valid ? 10 : 1)) == 'q') {
+		if (cv::waitKey(20 * (parking_valid ? 10 : 1)) == 'q') {
 			std::cout << "Sigkill received, exiting now..." << std::endl;
 			break;
 		}
 	}
 	cap.release();
-	cv::destroyAllWindows();
-
-	std::cout << "Valid id was found on " << (float)valid_tests/(float)number_of_test*100.0f << "% of the frames." << std::endl;
-
-	api->End();
-	delete api;
+	if (!FLAGS.headless)
+		cv::destroyAllWindows();
+
+	float seconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - run_start).count() / 1000.0f;
+	console << "Processed " << number_of_test << " frames in " << seconds << "s (" << number_of_test / seconds << " fps, " << (FLAGS.pipeline ? "pipeline" : "serial") << ")" << std::endl;
+	console << "Valid id was found on " << (float)valid_tests/(float)number_of_test*100.0f << "% of the frames." << std::endl;
+	source.report(console);
+	engine->report(console);
+	if (events != NULL)
+		delete events;
+	if (plate_log != NULL)
+		delete plate_log;
+	if (metrics != NULL)
+		delete metrics;
+
+	delete engine;
 	return 0;
 }
-
-/** Beskrivning:  Tar emot en sträng och beslutar ifall den innehåller några felaktiga tecken
-* Argument 1:   std::string& - referens till en sträng
-* Return:       bool - true om strängen är fri från felaktiga tecken, false annars
-* Exempel:
-*               valid_chars("YAH088") => true
-*               valid_chars("YAH08#") => false
-*               valid_chars("YaH088") => false
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-bool valid_chars(std::string &s) {
-	for (char c : s) {
-		if (!(	(c >= '0' && c <= '9') ||
-			(c >= 'A' && c <= 'Z')
-		     ))
-			return false;
-	}
-	return true;
-}
-
-
-/** Beskrivning:  Tar in sträng där felaktiga tecken och delar av strängen filtreras bort och eventuellt sparas i en annan sträng ifall något finns kvar efter filtreringen
-* Argument 1:   std::string - sträng att filtrera på
-* Argument 2:	  std::string& - referens till sträng där den nya strängen eventuellt sparas
-* Return:       void
-* Exempel:
-*               parse_answer("YAH088", str) => str = "YAH088"
-*               parse_answer("YAH0#8", str) => str = ""
-*               parse_answer("YAH 088", str) => str = "YAH088"
-*               parse_answer("YAH088 |", str) => str = "YAH088"
-*               parse_answer("| YAH088 |", str) => str = "YAH088"
-*               parse_answer("| YAH 088 |b", str) => str = "YAH088"
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-void parse_answer(std::string answer, std::string &answer_parsed) {
-	std::vector<std::string> answer_arr = _split(answer, " ", true);
-
-	/* Sometimes the plate is devided into two parts by a blank space, remove it */
-	for (int i = 0; i < answer_arr.size(); i++) {
-		answer_arr[i].erase(std::remove(answer_arr[i].begin(), answer_arr[i].end(), ' '), answer_arr[i].end()); //remove A from string
-	}
-
-	/* In case result has new lines, remove them */
-	for (int i = 0; i < answer_arr.size(); i++) {
-		answer_arr[i].erase(std::remove(answer_arr[i].begin(), answer_arr[i].end(), '\n'), answer_arr[i].end()); //remove A from string
-	}
-
-	/* Remove element that doesn't have three characters */
-	answer_arr.erase(std::remove_if(answer_arr.begin(), answer_arr.end(), [](std::string &s) {
-				if (valid_chars(s))
-					return s.length() != 3 && s.length() != 6; // Sometimes the plate is devided into numbers and letters, sometimes they end up together
-				else
-					return true;
-		}), answer_arr.end()
-	);
-
-	/* Assembly */
-	for (std::string s : answer_arr)
-		answer_parsed += s;
-
-	/* Validate final answer */
-	if (answer_parsed.length() != 6)
-		answer_parsed = ""; // Failsafe: if answer isn't valid, we shall not use it
-}
-
-/** Beskrivning:  Tar in kandidater för en bild och klipper ut rutor som innehåller kandidaterna, dessa rutor skickas till tesseract api genom run_ocr() och spottar ut
-*									eventuellt funna registreringsskyltar efter att ha matchat dessa mot en lista av godkänt parkerade bilar
-* Argument 1:   tesseract::TessBaseAPI* - pekare till tesseract api
-* Argument 2:	  cv::Mat& - referens bild att klippa ur kandidaterna från
-* Argument 3:	  std::vector<std::vector<cv::Point>>& - referens till eventuella kandidater för eventuella registreringsskyltar
-* Argument 4:   std::vector<std::string>& - lista över känt parkerade bilar
-* Return:       std::vector<struct Match> - en vector av strukturen Match: eventuella matchningar
-* Exempel:
-*               std::vector<Match> matches = extract_ids(api, image, candidates, known_cars) => vector över strukturen Match, en för varje eventuell registreringsskylt
-*							  																																								samt dess status, ifall den är godkänd eller inte
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-std::vector<struct Match> extract_ids(tesseract::TessBaseAPI *api, cv::Mat &frame, std::vector<std::vector<cv::Point>> &candidates, std::vector<std::string> &known_cars) {
-	FRAME_METADATA.frame_w = frame.cols;
-	FRAME_METADATA.frame_h = frame.rows;
-	FRAME_METADATA.ratio_w = frame.cols / (float) 512; // Aspect ratio may affect the performance, but will be do the job as for now
-	FRAME_METADATA.ratio_h = frame.rows / (float) 512; // Aspect ratio may affect the performance
-
-
-	// Convert to rectangle and also filter out the non-rectangle-shape.
-	std::vector<cv::Rect> rectangles;
-	for (std::vector<cv::Point> currentCandidate : candidates) {
-		cv::Rect boundingRect = cv::boundingRect(currentCandidate); // Create a rect around our candidate
-		float difference = boundingRect.area() - cv::contourArea(currentCandidate); // Get the difference in area between bouding rect and the area of the countour of the candidate
-		if (difference < RECT_DIFF) { // If those two areas are similar enough, candidate is probably a rectangle
-			rectangles.push_back(boundingRect); // Add it to possible number plates
-		}
-	}
-
-	// Remove rectangle with wrong aspect ratio.
-	rectangles.erase(std::remove_if(rectangles.begin(), rectangles.end(), [](cv::Rect temp) {
-				const float aspect_ratio = temp.width / (float) temp.height; // calculate aspect ration
-				return aspect_ratio < MIN_AR || aspect_ratio > MAX_AR; // if aspect ratio is outside allowed range, remove it
-				}), rectangles.end());
-
-	std::string answer;
-	std::string answer_parsed;
-	std::vector<struct Match> matches;
-	for (cv::Rect rect : rectangles) {
-		struct Match match;
-		answer_parsed = "";
-		cv::Range cols(rect.x * FRAME_METADATA.ratio_w, (rect.x + rect.width) * FRAME_METADATA.ratio_w);
-		cv::Range rows(rect.y * FRAME_METADATA.ratio_h, (rect.y + rect.height) * FRAME_METADATA.ratio_h);
-		cv::Mat crop = frame(rows, cols);
-		run_ocr(api, crop, answer);
-		parse_answer(answer, answer_parsed);
-
-		match.rectangle = rect;
-		match.id = answer_parsed;
-		match.id_valid = answer_parsed.length() > 1;
-		match.parking_valid = false;
-		for (std::string s : known_cars) {
-			if (strcmp(s.c_str(), answer_parsed.c_str()) == 0) {
-				match.parking_valid = true;
-				break;
-			}
-		}
-		matches.push_back(match);
-
-		debug_img("crop", crop);
-	}
-	return matches;
-}
-
-
-/** Beskrivning:  Tar in en bild där eventuella matchningar ritas ut i form av rutor kring kandidater till registreringsskyltar, tillsammans med funnen text ifall där är någon,
-*									samt ifall den finns med i listan för godkänt parkerade skyltar
-* Argument 1:   cv::Mat& - referens till bild där eventuella matchningar ritas
-* Argument 2:	  std::vector<Match>& - referens till vector över strukturen Match, en lista över eventuella matchningar
-* Argument 3:	  std::vector<std::vector<cv::Point>>& - referens för eventuella kandidater för eventuella registreringsskyltar
-* Return:       void
-* Exempel:
-*               drawMatches(image, matches, candidates); => rutor och text ritas, ifall matchningar finns, på bilden
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-void drawMatches(cv::Mat &frame, std::vector<Match> &matches, std::vector<std::vector<cv::Point>> &candidates) {
-
-	// Draw the bounding box of the possible numberplate
-	for (struct Match match : matches) {
-		cv::Scalar color;
-		if (match.parking_valid) {
-			color = cv::Scalar(0, 255, 0); // Blue Green Red, BGR
-		} else if (match.id_valid) {
-			color = cv::Scalar(0, 0, 255);
-		} else {
-			color = cv::Scalar(255, 255, 255);
-		}
-		cv::rectangle(
-				frame,
-				cv::Point(match.rectangle.x * FRAME_METADATA.ratio_w, match.rectangle.y * FRAME_METADATA.ratio_h),
-				cv::Point((match.rectangle.x + match.rectangle.width) * FRAME_METADATA.ratio_w, (match.rectangle.y + match.rectangle.height) * FRAME_METADATA.ratio_h),
-				color,
-				3,
-				cv::LINE_8,
-				0
-			);
-		cv::putText(
-				frame,
-				match.id,
-				cv::Point((match.rectangle.x) * FRAME_METADATA.ratio_w, (match.rectangle.y + match.rectangle.height - 30) * FRAME_METADATA.ratio_h),
-				cv::FONT_HERSHEY_DUPLEX,
-				1.0f,
-				color,
-				2
-			);
-		if (match.id_valid && match.parking_valid) {
-			cv::putText(
-					frame,
-					"OK " + match.id,
-					cv::Point((match.rectangle.x) * FRAME_METADATA.ratio_w, (match.rectangle.y + match.rectangle.height) * FRAME_METADATA.ratio_h),
-					cv::FONT_HERSHEY_DUPLEX,
-					1.0f,
-					color,
-					2
-				);
-		}
-	}
-
-	// Print circles
-	int i = 0;
-	for (std::vector<cv::Point> currentCandidate : candidates) {
-		for (cv::Point p : currentCandidate) {
-			cv::Point new_p = cv::Point(p.x * FRAME_METADATA.ratio_w, p.y * FRAME_METADATA.ratio_h);
-			cv::Scalar color = cv::Scalar(0, (25*i)&255, (255-25*i)&255);
-			cv::circle(frame, new_p, 4, color);
-		}
-		i++;
-	}
-}
-
-/** Beskrivning:  Tar in text och bild för att sedan, ifall rätt flagga är satt, spara bilden i en mapp vid namn "debug/" med filnamnet startat på argument 1 och avslutat
-*									med ett nummer och filtypen
-* Argument 1:   const char* - pekare till constant char, den pekar på en sträng i minnet som sedan tar del i namnet för den sparade filen
-* Argument 2:	  cv::Mat& - referens till den bild att spara
-* Return:       void
-* Exempel:
-*               debug_img("GaussianBlur", image); => fil sparas med namnet "GaussianBlur_1.jpg" och innehållet av bilden "image"
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-void debug_img(const char* name, cv::Mat &img) {
-	if (FLAGS.debug) {
-		/* Create image path */
-		std::string 	path  = "debug/";
-		path += std::to_string(debug_imgs_cnt);
-		path += "-";
-		path += name;
-		path += ".jpg";
-		imwrite(path, img);
-		debug_imgs_cnt++;
-	}
-}
-
-/** Beskrivning:  Tar in en bild och utför en serie av algoritmer för att peka ut kandidater för eventuella registreringsskyltar. Dessa retuneras sedan
-* Argument 1:   cv::Mat& - referens till bild där eventuella kandidater skall hittas
-* Return:       std::vector<std::vector<cv::Point>> - vector av en vector för eventuella kandidater för eventuella registreringsskyltar
-* Exempel:
-*               candidates = locateCandidates(image); => returnerar en vector av eventuella registreringsskyltar, varje skylt representerar en egen vector av punkter (kandidater)
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-std::vector<std::vector<cv::Point>> locateCandidates(cv::Mat &frame) {
-	// Reduce the image dimension to process
-	cv::Mat processedFrame = frame;
-	cv::resize(frame, processedFrame, cv::Size(512, 512));
-
-	debug_img("start", processedFrame);
-
-	// Must be converted to grayscale
-	if (frame.channels() == 3) {
-		cv::cvtColor(processedFrame, processedFrame, cv::COLOR_BGR2GRAY);
-	}
-
-	debug_img("grayscale", processedFrame);
-
-	// Remove islands, especially the eu country character such as "s" for sweden or "hr" for croatia. Otherwise this will mess with the rectangle
-	cv::Mat largerKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(4, 4));
-	cv::morphologyEx(processedFrame, processedFrame, cv::MORPH_OPEN, largerKernel);
-
-	debug_img("removed_island", processedFrame);
-
-	// Perform blackhat morphological operation, reveal dark regions on light backgrounds
-	cv::Mat blackhatFrame;
-	cv::Mat rectangleKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(13, 5)); // Shapes are set 13 pixels wide by 5 pixels tall
-	cv::morphologyEx(processedFrame, blackhatFrame, cv::MORPH_BLACKHAT, rectangleKernel);
-
-	debug_img("morphological_opt", blackhatFrame);
-
-	// Find license plate based on whiteness property
-	cv::Mat lightFrame;
-	cv::Mat squareKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
-	cv::morphologyEx(processedFrame, lightFrame, cv::MORPH_CLOSE, squareKernel);
-	cv::threshold(lightFrame, lightFrame, 0, 255, cv::THRESH_OTSU);
-
-	debug_img("white_regions", lightFrame);
-
-	// Compute Sobel gradient representation from blackhat using 32 float,
-	// and then convert it back to normal [0, 255] single channel
-	cv::Mat gradX;
-	double minVal, maxVal;
-	int dx = 1, dy = 0, ddepth = CV_32F, ksize = -1;
-	cv::Sobel(blackhatFrame, gradX, ddepth, dx, dy, ksize);
-	gradX = cv::abs(gradX);
-	cv::minMaxLoc(gradX, &minVal, &maxVal);
-	gradX = 255 * ((gradX - minVal) / (maxVal - minVal));
-	gradX.convertTo(gradX, CV_8U);
-
-	debug_img("sobel", gradX);
-
-	// Blur the gradient result, and apply closing operation
-	cv::GaussianBlur(gradX, gradX, cv::Size(5,5), 0);
-	debug_img("blur", gradX);
-	cv::morphologyEx(gradX, gradX, cv::MORPH_CLOSE, rectangleKernel);
-	debug_img("morph", gradX);
-	cv::threshold(gradX, gradX, 0, 255, cv::THRESH_OTSU);
-
-	debug_img("thres", gradX);
-
-	// Erode and dilate
-	cv::erode(gradX, gradX, 2);
-	cv::dilate(gradX, gradX, 2);
-
-	debug_img("erode_dilate", gradX);
-
-	// Bitwise AND between threshold result and light regions
-	cv::bitwise_and(gradX, gradX, lightFrame);
-	cv::dilate(gradX, gradX, 2);
-	cv::erode(gradX, gradX, 1);
-
-	debug_img("bitwise_AND", gradX);
-
-
-	// Find contours in the thresholded image and sort by size
-	std::vector<std::vector<cv::Point>> contours;
-	cv::findContours(gradX, contours, cv::noArray(), cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-	std::sort(contours.begin(), contours.end(), compareContourAreas);
-	std::vector<std::vector<cv::Point>> top_contours;
-	if (contours.size() > KEEP) {
-		top_contours.assign(contours.end() - KEEP, contours.end()); // Descending order
-	}
-
-
-	return top_contours;
-}
-
-/** Beskrivning:  Funktion för att gämföra två kandidat vectorer, används i sorterings algoritm
-* Argument 1:   std::vector<cv::Point>& - referens till en vector av punkter att gämföras
-* Argument 2:   std::vector<cv::Point>& - referens till en vector av punkter att gämföras
-* Return:       bool - true ifall arean där alla punkter i första vectorn, är mindre än i andra vectorn
-* Exempel:
-*               compareContourAreas(countour1, countour2) => true ifall arean där alla punkter i countour1, är mindre än i countour2
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-bool compareContourAreas (std::vector<cv::Point>& contour1, std::vector<cv::Point>& contour2) {
-	const double i = fabs(contourArea(cv::Mat(contour1)));
-	const double j = fabs(contourArea(cv::Mat(contour2)));
-	return (i < j);
-}
-
-/** Beskrivning:  Funktionen tar in en sträng, klipper upp denna strängen vid specifka matchningar, och filtrerar bort eventuella specifka dubbel matchningar
-* Argument 1:   std::string - sträng att dela upp
-* Argument 2:   std::string - specifika matchningen att klippa strängen vid
-* Return:       std::vector<std::string> - vector av strängar
-* Exempel:
-*               _split("hej där  victor!", " ", true) = ["hej", "där", "victor!"]
-*               _split("hej där  victor!", " ", false) = ["hej", "där", "", "victor!"]
-*
-* By:           Vigor Turujlija Gamelius
-* Date:         2022-06-03
-**/
-std::vector<std::string> _split(std::string s, std::string delimiter, bool avoid_double){
-	std::vector<std::string> output;
-
-	size_t pos = 0;
-	std::string token;
-	while ((pos = s.find(delimiter)) != std::string::npos) {
-		/* If pos is 0 we have a double delimiter and something is probably wrong */
-		if (pos == 0 && avoid_double) {
-			s.erase(0, 1);
-			continue;
-		}
-		token = s.substr(0, pos);
-		output.push_back(token);
-		s.erase(0, pos + delimiter.length());
-	}
-	// add the rest of the string to last element
-	output.push_back(s);
-	return output;
-}
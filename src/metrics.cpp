@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "metrics.hpp"
+
+Metrics METRICS;
+
+const double Histogram::bounds[HISTOGRAM_BUCKETS] = {
+	0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5
+};
+
+/** Beskrivning:  Konstruktor som nollställer alla hinkar
+* Return:       Histogram - Histogram objekt
+* Exempel:
+*               Histogram histogram => tomt histogram
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+Histogram::Histogram() {
+	for (int i = 0; i <= HISTOGRAM_BUCKETS; i++)
+		this->buckets[i].store(0, std::memory_order_relaxed);
+}
+
+/** Beskrivning:  Lägger till en observation. Endast hinken som observationen hamnar i räknas upp, de kumulativa värdena räknas fram vid export
+* Argument 1:   double - latens i sekunder
+* Return:       void
+* Exempel:
+*               histogram.observe(0.004)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Histogram::observe(double seconds) {
+	int bucket = 0;
+	while (bucket < HISTOGRAM_BUCKETS && seconds > bounds[bucket])
+		bucket++;
+	this->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	this->sum_ns.fetch_add((uint64_t) (seconds * 1e9), std::memory_order_relaxed);
+}
+
+/** Beskrivning:  Skriver histogrammet i Prometheus textformat, med kumulativa hinkar
+* Argument 1:   std::string& - referens till texten som raderna läggs till i
+* Argument 2:   const char* - namn på mätvärdet
+* Argument 3:   const char* - etiketter utan klammerparenteser, till exempel "stage=\"ocr\""
+* Return:       void
+* Exempel:
+*               histogram.write(out, "anpr_stage_duration_seconds", "stage=\"ocr\"") => anpr_stage_duration_seconds_bucket{stage="ocr",le="0.0001"} 0 ...
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Histogram::write(std::string &out, const char *name, const char *labels) const {
+	char line[256];
+	uint64_t cumulative = 0;
+	for (int i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+		cumulative += this->buckets[i].load(std::memory_order_relaxed);
+		if (i < HISTOGRAM_BUCKETS)
+			snprintf(line, sizeof(line), "%s_bucket{%s,le=\"%g\"} %llu\n", name, labels, bounds[i], (unsigned long long) cumulative);
+		else
+			snprintf(line, sizeof(line), "%s_bucket{%s,le=\"+Inf\"} %llu\n", name, labels, (unsigned long long) cumulative);
+		out += line;
+	}
+	snprintf(line, sizeof(line), "%s_sum{%s} %.9f\n", name, labels, this->sum_ns.load(std::memory_order_relaxed) / 1e9);
+	out += line;
+	snprintf(line, sizeof(line), "%s_count{%s} %llu\n", name, labels, (unsigned long long) cumulative);
+	out += line;
+}
+
+/** Beskrivning:  Lägger till en räknare eller mätare i Prometheus textformat
+* Argument 1:   std::string& - referens till texten
+* Argument 2:   const char* - namn på mätvärdet
+* Argument 3:   const char* - typ, "counter" eller "gauge"
+* Argument 4:   const char* - beskrivning
+* Argument 5:   long long - värdet
+* Return:       void
+* Exempel:
+*               write_value(out, "anpr_ocr_calls_total", "counter", "...", 42) => "# HELP ...\n# TYPE ...\nanpr_ocr_calls_total 42\n"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static void write_value(std::string &out, const char *name, const char *type, const char *help, long long value) {
+	char line[512];
+	snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %lld\n", name, help, name, type, name, value);
+	out += line;
+}
+
+/** Beskrivning:  Skriver ett etikettvärde med citattecken, bakstreck och radbrytningar kodade som Prometheus kräver
+* Argument 1:   const std::string& - värdet
+* Return:       std::string - kodat värde utan citattecken runt
+* Exempel:
+*               label_value("a\"b") => "a\\\"b"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static std::string label_value(const std::string &value) {
+	std::string escaped;
+	for (char c : value) {
+		if (c == '\\' || c == '"')
+			escaped += '\\';
+		if (c == '\n')
+			escaped += "\\n";
+		else
+			escaped += c;
+	}
+	return escaped;
+}
+
+/** Beskrivning:  Registrerar en ströms mätvärden så att de tas med i exposition(), de måste avregistreras innan de förstörs
+* Argument 1:   const StreamMetrics* - pekare till strömmens mätvärden
+* Return:       void
+* Exempel:
+*               METRICS.addStream(&stream->metrics)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Metrics::addStream(const StreamMetrics *stream) {
+	std::lock_guard<std::mutex> lock(this->streams_mutex);
+	this->streams.push_back(stream);
+}
+
+/** Beskrivning:  Avregistrerar en ströms mätvärden
+* Argument 1:   const StreamMetrics* - pekare till strömmens mätvärden
+* Return:       void
+* Exempel:
+*               METRICS.removeStream(&stream->metrics)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Metrics::removeStream(const StreamMetrics *stream) {
+	std::lock_guard<std::mutex> lock(this->streams_mutex);
+	this->streams.erase(std::remove(this->streams.begin(), this->streams.end(), stream), this->streams.end());
+}
+
+/** Beskrivning:  Alla mätvärden i Prometheus textformat
+* Return:       std::string - texten som /metrics svarar med
+* Exempel:
+*               METRICS.exposition() => "# HELP anpr_stage_duration_seconds ..."
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string Metrics::exposition() const {
+	std::string out;
+	out += "# HELP anpr_stage_duration_seconds Time spent in each stage of the ANPR algorithm\n";
+	out += "# TYPE anpr_stage_duration_seconds histogram\n";
+	this->frame.write(out, "anpr_stage_duration_seconds", "stage=\"frame\"");
+	this->locate.write(out, "anpr_stage_duration_seconds", "stage=\"locate_candidates\"");
+	this->extract_ids.write(out, "anpr_stage_duration_seconds", "stage=\"extract_ids\"");
+	this->ocr.write(out, "anpr_stage_duration_seconds", "stage=\"run_ocr\"");
+	this->ocr_fast.write(out, "anpr_stage_duration_seconds", "stage=\"ocr_fast\"");
+
+	write_value(out, "anpr_frames_total", "counter", "Frames processed", this->frames.get());
+	write_value(out, "anpr_frames_grabbed_total", "counter", "Frames grabbed from the stream, analysed or skipped", this->frames_grabbed.get());
+	write_value(out, "anpr_frames_retrieved_total", "counter", "Frames retrieved from the stream for analysis", this->frames_retrieved.get());
+	write_value(out, "anpr_candidates_found_total", "counter", "Candidates returned by locateCandidates", this->candidates_found.get());
+	write_value(out, "anpr_candidates_rejected_rect_total", "counter", "Candidates rejected by RECT_DIFF", this->candidates_rejected_rect.get());
+	write_value(out, "anpr_candidates_rejected_aspect_total", "counter", "Candidates rejected by aspect ratio", this->candidates_rejected_aspect.get());
+	write_value(out, "anpr_ocr_calls_total", "counter", "Calls to run_ocr", this->ocr_calls.get());
+	write_value(out, "anpr_ocr_fast_hits_total", "counter", "Candidates read by the fast classifier", this->ocr_fast_hits.get());
+	write_value(out, "anpr_ocr_fast_misses_total", "counter", "Candidates the fast classifier passed on to Tesseract", this->ocr_fast_misses.get());
+	write_value(out, "anpr_valid_reads_total", "counter", "Candidates read as a valid plate", this->valid_reads.get());
+	write_value(out, "anpr_parking_valid_total", "counter", "Valid plates found in the known cars list", this->parking_valid.get());
+	write_value(out, "anpr_queue_decoded_depth", "gauge", "Frames waiting for candidate location", this->queue_decoded.get());
+	write_value(out, "anpr_queue_located_depth", "gauge", "Frames waiting for OCR", this->queue_located.get());
+	write_value(out, "anpr_queue_recognized_depth", "gauge", "Frames waiting to be rendered", this->queue_recognized.get());
+	write_value(out, "anpr_processing_width", "gauge", "Long side of the frame while locating candidates", this->processing_width.get());
+	write_value(out, "anpr_candidate_limit", "gauge", "Largest number of candidates sent to OCR per frame", this->candidate_limit.get());
+	write_value(out, "anpr_frame_stride", "gauge", "Every n:th frame is processed", this->frame_stride.get());
+
+	std::lock_guard<std::mutex> lock(this->streams_mutex);
+	if (this->streams.empty())
+		return out;
+	out += "# HELP anpr_stream_frame_duration_seconds Time from decode to result per stream\n";
+	out += "# TYPE anpr_stream_frame_duration_seconds histogram\n";
+	for (const StreamMetrics *stream : this->streams) {
+		std::string labels = "stream=\"" + label_value(stream->name) + "\"";
+		stream->frame.write(out, "anpr_stream_frame_duration_seconds", labels.c_str());
+	}
+	struct {
+		const char *name;
+		const char *type;
+		const char *help;
+		const Counter StreamMetrics::*counter;
+		const Gauge StreamMetrics::*gauge;
+	} values[] = {
+		{ "anpr_stream_frames_total", "counter", "Frames processed per stream", &StreamMetrics::frames, NULL },
+		{ "anpr_stream_frames_dropped_total", "counter", "Frames dropped by backpressure per stream", &StreamMetrics::frames_dropped, NULL },
+		{ "anpr_stream_valid_reads_total", "counter", "Candidates read as a valid plate per stream", &StreamMetrics::valid_reads, NULL },
+		{ "anpr_stream_parking_valid_total", "counter", "Valid plates found in the stream's known cars list", &StreamMetrics::parking_valid, NULL },
+		{ "anpr_stream_queue_depth", "gauge", "Decoded frames waiting for a worker per stream", NULL, &StreamMetrics::queue },
+	};
+	for (auto &value : values) {
+		out += std::string("# HELP ") + value.name + " " + value.help + "\n";
+		out += std::string("# TYPE ") + value.name + " " + value.type + "\n";
+		for (const StreamMetrics *stream : this->streams) {
+			long long n = value.counter != NULL ? (long long) (stream->*value.counter).get() : (long long) (stream->*value.gauge).get();
+			out += std::string(value.name) + "{stream=\"" + label_value(stream->name) + "\"} " + std::to_string(n) + "\n";
+		}
+	}
+	return out;
+}
+
+/** Beskrivning:  Konstruktor som startar http servern och/eller tråden som skriver filen
+* Argument 1:   int - port för http servern på 127.0.0.1, 0 för ingen server
+* Argument 2:   const std::string& - sökväg till filen, tom för ingen fil
+* Argument 3:   int - millisekunder mellan varje gång filen skrivs
+* Return:       MetricsExporter - MetricsExporter objekt, ok() är false ifall porten inte kunde öppnas
+* Exempel:
+*               MetricsExporter exporter(0, "/var/lib/node_exporter/anpr.prom", 5000) => filen skrivs var femte sekund
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+MetricsExporter::MetricsExporter(int port_in, const std::string &path_in, int interval_ms_in) {
+	this->port = port_in;
+	this->path = path_in;
+	this->interval_ms = interval_ms_in > 0 ? interval_ms_in : 5000;
+
+	if (this->port > 0) {
+		this->server_fd = socket(AF_INET, SOCK_STREAM, 0);
+		int reuse = 1;
+		setsockopt(this->server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(this->port);
+		if (this->server_fd < 0
+			|| bind(this->server_fd, (struct sockaddr*) &address, sizeof(address)) != 0
+			|| listen(this->server_fd, 8) != 0) {
+			if (this->server_fd >= 0)
+				close(this->server_fd);
+			this->server_fd = -1;
+		} else {
+			this->server = std::thread(&MetricsExporter::serve, this);
+		}
+	}
+	if (!this->path.empty())
+		this->writer = std::thread(&MetricsExporter::write_file, this);
+}
+
+/** Beskrivning:  Destruktor som stoppar trådarna, filen skrivs en sista gång
+* Return:       void
+* Exempel:
+*               delete exporter
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+MetricsExporter::~MetricsExporter() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	if (this->server.joinable())
+		this->server.join();
+	if (this->writer.joinable())
+		this->writer.join();
+	if (this->server_fd >= 0)
+		close(this->server_fd);
+}
+
+/** Beskrivning:  Http serverns loop, svarar på GET /metrics och 404 på allt annat. Kontrollerar regelbundet ifall den ska stoppas
+* Return:       void
+* Exempel:
+*               std::thread(&MetricsExporter::serve, this)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MetricsExporter::serve() {
+	struct pollfd listener = { this->server_fd, POLLIN, 0 };
+	char request[1024];
+	while (!this->stopping) {
+		if (poll(&listener, 1, 200) <= 0)
+			continue;
+		int client = accept(this->server_fd, NULL, NULL);
+		if (client < 0)
+			continue;
+
+		struct pollfd reader = { client, POLLIN, 0 };
+		ssize_t length = poll(&reader, 1, 1000) > 0 ? recv(client, request, sizeof(request) - 1, 0) : -1;
+		std::string response;
+		if (length > 0) {
+			request[length] = '\0';
+			if (strncmp(request, "GET /metrics", 12) == 0) {
+				std::string body = METRICS.exposition();
+				response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+					+ std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+			} else {
+				response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+			}
+			size_t sent = 0;
+			while (sent < response.size()) {
+				ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+				if (n <= 0)
+					break;
+				sent += n;
+			}
+		}
+		close(client);
+	}
+}
+
+/** Beskrivning:  Filskrivarens loop, skriver om filen var interval_ms millisekund och en sista gång när exportören stoppas
+* Return:       void
+* Exempel:
+*               std::thread(&MetricsExporter::write_file, this)
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MetricsExporter::write_file() {
+	std::string temporary = this->path + ".tmp";
+	bool last = false;
+	while (!last) {
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			last = this->wake.wait_for(lock, std::chrono::milliseconds(this->interval_ms), [this] { return this->stopping.load(); });
+		}
+		std::string body = METRICS.exposition();
+		FILE *file = fopen(temporary.c_str(), "w");
+		if (file == NULL) {
+			std::cerr << "Cannot write metrics to " << temporary << std::endl;
+			continue;
+		}
+		fwrite(body.data(), 1, body.size(), file);
+		fclose(file);
+		rename(temporary.c_str(), this->path.c_str());
+	}
+}
+
+/** Beskrivning:  Returnerar en percentil ur en sorterad lista av mätningar
+* Argument 1:   const std::vector<double>& - referens till sorterade mätningar
+* Argument 2:   double - percentil mellan 0 och 100
+* Return:       double - värdet vid percentilen, närmaste rang
+* Exempel:
+*               percentile({1, 2, 3, 4}, 50) => 2
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+double percentile(const std::vector<double> &sorted, double p) {
+	if (sorted.empty())
+		return 0;
+	size_t rank = (size_t) std::ceil(p / 100.0 * sorted.size());
+	return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "motion_gate.hpp"
+
+/** Beskrivning:  Konstruktor som sätter privata variabler i klassen MotionGate
+* Argument 1:   MotionGateConfig - konfiguration för förändringsdetekteringen
+* Return:       MotionGate - MotionGate objekt
+* Exempel:
+*               MotionGate gate(config) => skapar en gate utan bakgrundsmodell, första bildrutan körs alltid
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+MotionGate::MotionGate(MotionGateConfig config_in) {
+	this->config = config_in;
+	if (this->config.width < 16)
+		this->config.width = 16;
+}
+
+/** Beskrivning:  Jämför en nedskalad gråskaleversion av bildrutan mot bakgrundsmodellen och uppdaterar sedan modellen
+* Argument 1:   const cv::Mat& - referens till bildrutan i full upplösning
+* Argument 2:   cv::Rect& - referens till rektangel där den del av bildrutan som ska köras sparas, hela bildrutan ifall större delen ändrats
+* Return:       bool - false ifall bildrutan är oförändrad och kan hoppas över
+* Exempel:
+*               gate.check(frame, roi) => true och roi = cv::Rect(320, 180, 400, 300) när en bil rör sig i mitten av bilden
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool MotionGate::check(const cv::Mat &frame, cv::Rect &roi) {
+	roi = cv::Rect(0, 0, frame.cols, frame.rows);
+	double frame_pixels = (double) frame.cols * frame.rows;
+	this->frames++;
+	this->pixels += frame_pixels;
+
+	// Downsample with preserved aspect ratio, area interpolation doubles as a cheap noise filter
+	int height = std::max(1, cvRound(this->config.width * frame.rows / (double) frame.cols));
+	cv::resize(frame, this->small, cv::Size(this->config.width, height), 0, 0, cv::INTER_AREA);
+	if (this->small.channels() == 3)
+		cv::cvtColor(this->small, this->small, cv::COLOR_BGR2GRAY);
+
+	if (this->background.empty() || this->background.size() != this->small.size()) {
+		this->small.convertTo(this->background, CV_32F);
+		return true;
+	}
+
+	this->background.convertTo(this->background_8u, CV_8U);
+	cv::absdiff(this->small, this->background_8u, this->mask);
+	cv::threshold(this->mask, this->mask, this->config.pixel_threshold, 255, cv::THRESH_BINARY);
+	cv::accumulateWeighted(this->small, this->background, this->config.learning_rate);
+
+	float changed = cv::countNonZero(this->mask) / (float) this->mask.total();
+	if (changed < this->config.min_changed) {
+		this->frames_skipped++;
+		this->pixels_skipped += frame_pixels;
+		return false;
+	}
+	if (changed > this->config.full_frame)
+		return true;
+
+	// Scale the changed region back up and pad it so a plate at the edge of the motion is not cut
+	cv::Rect changed_rect = cv::boundingRect(this->mask);
+	float scale = frame.cols / (float) this->small.cols;
+	int pad_x = cvRound(this->config.margin * frame.cols);
+	int pad_y = cvRound(this->config.margin * frame.rows);
+	cv::Rect region(
+		cvFloor(changed_rect.x * scale) - pad_x,
+		cvFloor(changed_rect.y * scale) - pad_y,
+		cvCeil(changed_rect.width * scale) + 2 * pad_x,
+		cvCeil(changed_rect.height * scale) + 2 * pad_y
+	);
+	roi &= region;
+	if (roi.area() < frame_pixels) {
+		this->frames_partial++;
+		this->pixels_skipped += frame_pixels - roi.area();
+	}
+	return true;
+}
+
+/** Beskrivning:  Sparar resultatet av en körd bildruta som det som visas medan bilden är oförändrad. Kördes bara roi behåller de sparade
+*									matchningar och kandidater som inte ligger inom roi sin plats, så att en parkerad bil inte försvinner när en annan
+*									bil rör sig. Sparade som överlappar en ny matchning eller kandidat ersätts av den nya
+* Argument 1:   const cv::Rect& - den del av bildrutan som kördes
+* Argument 2:   std::vector<Match>& - referens till bildrutans nya matchningar, de behållna läggs till
+* Argument 3:   std::vector<std::vector<cv::Point>>& - referens till bildrutans nya kandidater, de behållna läggs till
+* Return:       void
+* Exempel:
+*               gate.hold(roi, matches, candidates) => matches innehåller även den parkerade bilen utanför roi
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MotionGate::hold(const cv::Rect &roi, std::vector<Match> &matches, std::vector<std::vector<cv::Point>> &candidates) {
+	auto outside = [&roi](const cv::Rect &rect) { return (rect & roi) != rect; };
+	size_t fresh_matches = matches.size();
+	for (const Match &held : this->held_matches) {
+		if (!outside(held.rectangle))
+			continue;
+		bool replaced = false;
+		for (size_t i = 0; i < fresh_matches && !replaced; i++)
+			replaced = (held.rectangle & matches[i].rectangle).area() > 0;
+		if (!replaced)
+			matches.push_back(held);
+	}
+	std::vector<cv::Rect> fresh_rectangles;
+	for (const std::vector<cv::Point> &candidate : candidates)
+		fresh_rectangles.push_back(cv::boundingRect(candidate));
+	for (const std::vector<cv::Point> &held : this->held_candidates) {
+		cv::Rect rect = cv::boundingRect(held);
+		if (!outside(rect))
+			continue;
+		bool replaced = false;
+		for (size_t i = 0; i < fresh_rectangles.size() && !replaced; i++)
+			replaced = (rect & fresh_rectangles[i]).area() > 0;
+		if (!replaced)
+			candidates.push_back(held);
+	}
+
+	this->held_matches		= matches;
+	this->held_candidates		= candidates;
+	this->held_parking_valid	= false;
+	this->held_id_valid		= false;
+	for (const Match &match : matches) {
+		if (match.parking_valid)
+			this->held_parking_valid = true;
+		if (match.id_valid)
+			this->held_id_valid = true;
+	}
+}
+
+/** Beskrivning:  Skriver ut hur många bildrutor och pixlar som hoppats över, för att kunna ställa in gränserna
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               gate.report(std::cout) => "Motion gate skipped 812 of 900 frames, 40 processed partially, 91.2% of pixels skipped"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MotionGate::report(std::ostream &out) {
+	out << "Motion gate skipped " << this->frames_skipped << " of " << this->frames << " frames, "
+		<< this->frames_partial << " processed partially, "
+		<< (this->pixels > 0 ? this->pixels_skipped / this->pixels * 100.0 : 0.0) << "% of pixels skipped" << std::endl;
+}
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "debug_images.hpp"
+#include "detection_context.hpp"
+#include "frame_source.hpp"
+#include "known_cars.hpp"
+#include "metrics.hpp"
+#include "motion_gate.hpp"
+#include "ocr_pool.hpp"
+#include "tracker.hpp"
+#include "pipeline.hpp"
+#include "multi_stream.hpp"
+
+/** Beskrivning:  Läser en konfiguration med en ström per rad: namn, källa, lista över godkänt parkerade bilar och valfri prioritet, åtskilda av mellanslag.
+*									Rader som börjar med # hoppas över. En källa med bara siffror öppnas som kamera med det indexet
+* Argument 1:   const std::string& - sökväg till konfigurationen
+* Argument 2:   std::vector<StreamConfig>& - referens där strömmarna sparas
+* Return:       bool - false ifall filen inte kunde öppnas eller en rad var felaktig
+* Exempel:
+*               read_stream_config("cameras.conf", streams) => streams = [{"entrance", "rtsp://10.0.0.5/live", "known_cars.txt", 2}, ...]
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool read_stream_config(const std::string &path, std::vector<StreamConfig> &streams) {
+	std::ifstream file(path);
+	if (!file.is_open())
+		return false;
+
+	std::string line;
+	int number = 0;
+	while (std::getline(file, line)) {
+		number++;
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		StreamConfig stream;
+		if (!(fields >> stream.name >> stream.source >> stream.known_cars)) {
+			std::cerr << path << ":" << number << ": expected name, source and known cars list" << std::endl;
+			return false;
+		}
+		int priority;
+		if (fields >> priority)
+			stream.priority = std::max(1, priority);
+		streams.push_back(stream);
+	}
+	return true;
+}
+
+/** Beskrivning:  Konstruktor som sätter privata variabler i klassen MultiStream, strömmarna läggs till med add()
+* Argument 1:   MultiStreamConfig - konfiguration för alla strömmar
+* Argument 2:   OcrPool& - referens till den gemensamma poolen av Tesseract motorer
+* Argument 3:   DebugImages* - pekare till skrivaren av debug bilder som alla strömmar delar, eller NULL
+* Return:       MultiStream - MultiStream objekt
+* Exempel:
+*               MultiStream streams(config, ocr, NULL) => inga strömmar och inga trådar
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+MultiStream::MultiStream(MultiStreamConfig config_in, OcrPool &ocr_in, DebugImages *debug_in) : ocr(ocr_in) {
+	this->config = config_in;
+	this->debug = debug_in;
+	if (this->config.pipeline.detect_threads < 1)
+		this->config.pipeline.detect_threads = 1;
+}
+
+/** Beskrivning:  Destruktor som stänger alla strömmar och frigör det som hör till dem
+* Return:       void
+* Exempel:
+*               delete streams => alla videoströmmar är stängda
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+MultiStream::~MultiStream() {
+	for (Stream *stream : this->streams) {
+		METRICS.removeStream(&stream->metrics);
+		if (stream->source != NULL)
+			delete stream->source;
+		stream->cap.release();
+		if (stream->tracker != NULL)
+			delete stream->tracker;
+		if (stream->gate != NULL)
+			delete stream->gate;
+		delete stream;
+	}
+	for (std::pair<const std::string, KnownCars*> &entry : this->known_cars)
+		delete entry.second;
+}
+
+/** Beskrivning:  Öppnar en ström och läser in dess lista över godkänt parkerade bilar, eller delar den med en tidigare ström med samma lista
+* Argument 1:   const StreamConfig& - strömmens namn, källa, lista och prioritet
+* Return:       bool - false ifall källan inte kunde öppnas
+* Exempel:
+*               streams.add({"entrance", "rtsp://10.0.0.5/live", "known_cars.txt", 2}) => true
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool MultiStream::add(const StreamConfig &stream_config) {
+	Stream *stream = new Stream();
+	stream->config = stream_config;
+	bool device = !stream_config.source.empty() && std::all_of(stream_config.source.begin(), stream_config.source.end(), [](char c) { return std::isdigit((unsigned char) c); });
+	if (device)
+		stream->cap.open(atoi(stream_config.source.c_str()));
+	else
+		stream->cap.open(stream_config.source);
+	if (!stream->cap.isOpened()) {
+		delete stream;
+		return false;
+	}
+
+	KnownCars *&known_cars = this->known_cars[stream_config.known_cars];
+	if (known_cars == NULL) {
+		known_cars = new KnownCars(stream_config.known_cars.c_str());
+		if (this->config.reload_interval > 0)
+			known_cars->watch(this->config.reload_interval);
+	}
+	stream->known_cars = known_cars;
+	stream->source = new FrameSource(stream->cap, this->config.sampling, this->config.luma);
+	if (this->config.track)
+		stream->tracker = new PlateTracker(this->config.tracker);
+	if (this->config.motion)
+		stream->gate = new MotionGate(this->config.motion_config);
+	stream->detection.processing_width = this->config.pipeline.processing_width;
+	stream->detection.bands = this->config.pipeline.bands;
+	stream->metrics.name = stream_config.name;
+	METRICS.addStream(&stream->metrics);
+	this->streams.push_back(stream);
+	return true;
+}
+
+/** Beskrivning:  Avkodningen för en ström, läser de bildrutor som samplingen väljer in i strömmens kö. När kön är full väntar tråden eller kastar den äldsta bildrutan beroende på Backpressure
+* Argument 1:   Stream* - strömmen
+* Return:       void
+* Exempel:
+*               std::thread(&MultiStream::decode, this, stream) => körs tills strömmen tar slut eller allt stoppas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MultiStream::decode(Stream *stream) {
+	while (true) {
+		FrameJob job;
+		job.start = std::chrono::steady_clock::now();
+		if (!stream->source->read(job.frame)) {
+			std::cerr << "Stream " << stream->config.name << " is closed or disconnected" << std::endl;
+			break;
+		}
+		if (job.frame.empty())
+			continue;
+		job.position_ms = stream->source->positionMs();
+		job.roi = cv::Rect(0, 0, job.frame.cols, job.frame.rows);
+		if (stream->gate != NULL)
+			job.unchanged = !stream->gate->check(job.frame, job.roi); // Only this thread checks the gate, the held result is written by the worker holding the stream
+
+		std::unique_lock<std::mutex> lock(this->mutex);
+		if (this->config.pipeline.backpressure == Backpressure::BLOCK) {
+			this->has_room.wait(lock, [&] { return this->stopping || stream->ready.size() < this->config.pipeline.queue_size; });
+		} else if (stream->ready.size() >= this->config.pipeline.queue_size) {
+			stream->ready.pop_front();
+			stream->metrics.frames_dropped.add();
+		}
+		if (this->stopping)
+			break;
+		job.seq = stream->seq++;
+		stream->ready.push_back(std::move(job));
+		stream->metrics.queue.set(stream->ready.size());
+		lock.unlock();
+		this->has_work.notify_one();
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	stream->finished = true;
+	this->has_work.notify_all(); // Idle workers may be waiting to see that everything is done
+}
+
+/** Beskrivning:  Väljer nästa ström att köra en bildruta från, den lediga strömmen med väntande bildrutor och lägst pass. Strömmens pass ökar med 1/prioritet,
+*									och en ström som varit tom får inte ett pass långt efter de andra så att den inte tar över när den kommer tillbaka. Mutex ska vara låst
+* Return:       Stream* - strömmen, eller NULL ifall ingen har något att köra just nu
+* Exempel:
+*               next() => strömmen med prioritet 2 väljs varannan gång när två strömmar med prioritet 2 och 1 har fulla köer, sett över tre val
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+Stream* MultiStream::next() {
+	Stream *best = NULL;
+	for (Stream *stream : this->streams) {
+		if (stream->busy || stream->ready.empty())
+			continue;
+		if (best == NULL || stream->pass < best->pass)
+			best = stream;
+	}
+	if (best == NULL)
+		return NULL;
+	double start = std::max(best->pass, this->virtual_time);
+	this->virtual_time = start;
+	best->pass = start + 1.0 / best->config.priority;
+	return best;
+}
+
+/** Beskrivning:  Kollar ifall alla strömmar är slut och tomma. Mutex ska vara låst
+* Return:       bool - true när arbetarna kan sluta
+* Exempel:
+*               done() => true när alla filer är färdigkörda
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool MultiStream::done() {
+	for (Stream *stream : this->streams) {
+		if (!stream->finished || !stream->ready.empty())
+			return false;
+	}
+	return true;
+}
+
+/** Beskrivning:  Kör lokalisering och ocr på en bildruta med strömmens egen arbetsyta, lista, spårning och förändringsdetektering
+* Argument 1:   Stream* - strömmen som bildrutan kommer från, arbetaren håller den
+* Argument 2:   FrameJob& - referens till bildrutan, resultatet sparas i den
+* Return:       void
+* Exempel:
+*               process(stream, job) => job.matches innehåller bildrutans matchningar
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MultiStream::process(Stream *stream, FrameJob &job) {
+	if (job.unchanged) {
+		// Nothing moved, the previous result still holds
+		job.matches		= stream->gate->held_matches;
+		job.candidates		= stream->gate->held_candidates;
+		job.parking_valid	= stream->gate->held_parking_valid;
+		job.id_valid		= stream->gate->held_id_valid;
+		return;
+	}
+
+	DebugFrame *debug = this->debug != NULL ? this->debug->begin(job.seq, stream->config.name) : NULL;
+	stream->detection.debug = debug;
+	auto start = std::chrono::steady_clock::now();
+	job.candidates = locateCandidatesInRegion(job.frame, job.roi, stream->detection);
+	auto located = std::chrono::steady_clock::now();
+	if (stream->tracker != NULL)
+		stream->tracker->limitTo(job.roi);
+	job.matches = extract_ids(this->ocr, job.frame, job.candidates, *stream->known_cars, stream->tracker, debug);
+	job.locate_ms = std::chrono::duration<double, std::milli>(located - start).count();
+	job.ocr_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - located).count();
+	if (stream->gate != NULL) {
+		// Plates outside the part that moved keep their previous result
+		stream->gate->hold(job.roi, job.matches, job.candidates);
+	}
+	for (Match &match : job.matches) {
+		if (match.parking_valid) {
+			job.parking_valid = true;
+			stream->metrics.parking_valid.add();
+		}
+		if (match.id_valid) {
+			job.id_valid = true;
+			stream->metrics.valid_reads.add();
+		}
+	}
+	stream->source->observe(job.id_valid);
+	if (this->debug != NULL)
+		this->debug->end(debug, job.frame, job.matches, job.candidates);
+}
+
+/** Beskrivning:  Arbetsloopen för en arbetare i den gemensamma poolen. Tar en bildruta i taget från den ström som står på tur, kör den och lämnar resultatet vidare
+* Argument 1:   BoundedQueue<std::pair<Stream*, FrameJob>>& - kö till den anroppande tråden i run()
+* Return:       void
+* Exempel:
+*               std::thread(&MultiStream::work, this, std::ref(results)) => körs tills alla strömmar är slut eller allt stoppas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MultiStream::work(BoundedQueue<std::pair<Stream*, FrameJob>> &results) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		Stream *stream = NULL;
+		this->has_work.wait(lock, [&] { return this->stopping || (stream = this->next()) != NULL || this->done(); });
+		if (stream == NULL)
+			break; // Stopping or every stream is done
+
+		stream->busy = true;
+		FrameJob job = std::move(stream->ready.front());
+		stream->ready.pop_front();
+		stream->metrics.queue.set(stream->ready.size());
+		lock.unlock();
+		this->has_room.notify_all();
+
+		this->process(stream, job);
+		bool delivered = results.push(std::make_pair(stream, std::move(job)));
+
+		lock.lock();
+		stream->busy = false;
+		this->has_work.notify_all(); // The stream may have more frames waiting
+		if (!delivered)
+			break;
+	}
+}
+
+/** Beskrivning:  Startar en avkodningstråd per ström och config.pipeline.detect_threads arbetare, och lämnar resultaten i den anroppande tråden
+*									eftersom fönster i OpenCV måste hanteras från samma tråd. Returnerar när alla strömmar är slut eller on_frame returnerar false
+* Argument 1:   std::function<bool(Stream&, FrameJob&)> - anroppas för varje färdig bildruta, i ordning inom varje ström, returnera false för att avbryta
+* Return:       void
+* Exempel:
+*               streams.run([](Stream &stream, FrameJob &job) { cv::imshow(stream.config.name, job.frame); return true; }) => ett fönster per ström
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MultiStream::run(std::function<bool(Stream&, FrameJob&)> on_frame) {
+	BoundedQueue<std::pair<Stream*, FrameJob>> results(this->config.pipeline.queue_size * std::max((size_t) 1, this->streams.size()), Backpressure::BLOCK);
+
+	for (Stream *stream : this->streams)
+		stream->decoder = std::thread(&MultiStream::decode, this, stream);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < this->config.pipeline.detect_threads; i++)
+		workers.emplace_back(&MultiStream::work, this, std::ref(results));
+
+	/* When every worker is done there are no more results */
+	std::thread closer([&] {
+		for (std::thread &worker : workers)
+			worker.join();
+		results.close();
+	});
+
+	std::pair<Stream*, FrameJob> result;
+	while (results.pop(result)) {
+		Stream &stream = *result.first;
+		FrameJob &job = result.second;
+		double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.start).count();
+		METRICS.frame.observe(latency);
+		METRICS.frames.add();
+		stream.metrics.frame.observe(latency);
+		stream.metrics.frames.add();
+		if (!on_frame(stream, job)) {
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->stopping = true;
+			}
+			this->has_work.notify_all();
+			this->has_room.notify_all();
+			results.close();
+			break;
+		}
+	}
+
+	closer.join();
+	for (Stream *stream : this->streams)
+		stream->decoder.join();
+}
+
+/** Beskrivning:  Skriver ut hur många bildrutor varje ström fick körda, hur många som kastades och vad samplingen sparade
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               streams.report(std::cout) => "Stream entrance (priority 2): 1800 frames, 0 dropped, 412 valid reads"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void MultiStream::report(std::ostream &out) {
+	for (Stream *stream : this->streams) {
+		out << "Stream " << stream->config.name << " (priority " << stream->config.priority << "): "
+			<< stream->metrics.frames.get() << " frames, " << stream->metrics.frames_dropped.get() << " dropped, "
+			<< stream->metrics.valid_reads.get() << " valid reads" << std::endl;
+		stream->source->report(out);
+		if (stream->gate != NULL)
+			stream->gate->report(out);
+	}
+}
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <map>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "ocr_pool.hpp"
+#include "debug_images.hpp"
+#include "detection_context.hpp"
+#include "frame_source.hpp"
+#include "known_cars.hpp"
+#include "latency_budget.hpp"
+#include "metrics.hpp"
+#include "motion_gate.hpp"
+#include "tracker.hpp"
+#include "pipeline.hpp"
+
+/** Beskrivning:  Konstruktor som sätter privata variabler i klassen Pipeline
+* Argument 1:   PipelineConfig - konfiguration för pipelinen
+* Argument 2:   OcrPool& - referens till poolen av Tesseract motorer
+* Argument 3:   KnownCars& - referens till index över godkänt parkerade bilar
+* Argument 4:   PlateTracker* - pekare till spårning mellan bildrutor, eller NULL
+* Argument 5:   MotionGate* - pekare till förändringsdetektering, eller NULL
+* Argument 6:   LatencyBudget* - pekare till styrningen efter tidsbudget, eller NULL
+* Argument 7:   DebugImages* - pekare till skrivaren av debug bilder, eller NULL
+* Return:       Pipeline - Pipeline objekt
+* Exempel:
+*               Pipeline pipeline(config, ocr, known_cars, tracker, gate, budget, NULL) => skapar ett pipeline objekt, inga trådar startas förrän run() anroppas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+Pipeline::Pipeline(PipelineConfig config_in, OcrPool &ocr_in, KnownCars &known_cars_in, PlateTracker *tracker_in, MotionGate *gate_in, LatencyBudget *budget_in, DebugImages *debug_in) : ocr(ocr_in), known_cars(known_cars_in) {
+	this->config = config_in;
+	this->tracker = tracker_in;
+	this->gate = gate_in;
+	this->budget = budget_in;
+	this->debug = debug_in;
+	if (this->config.detect_threads < 1)
+		this->config.detect_threads = 1;
+}
+
+/** Beskrivning:  Avkodningssteget, läser de bildrutor som ska analyseras från videoströmmen och numrerar dem. Kastas en bildruta av backpressure policyn
+*									skickas en gravsten vidare så att ocr steget vet att numret aldrig kommer
+* Argument 1:   FrameSource& - referens till videoströmmen och dess sampling
+* Argument 2:   BoundedQueue<FrameJob>& - kö till lokaliseringssteget
+* Argument 3:   BoundedQueue<FrameJob>& - kö till ocr steget, används endast för gravstenar
+* Return:       void
+* Exempel:
+*               decode(source, decoded, located) => körs tills strömmen tar slut eller pipelinen stoppas
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Pipeline::decode(FrameSource &source, BoundedQueue<FrameJob> &decoded, BoundedQueue<FrameJob> &located) {
+	long seq = 0;
+	while (!this->stopping) {
+		FrameJob job;
+		job.start = std::chrono::steady_clock::now();
+		// Frames left out by the sampling or the latency budget are grabbed without being retrieved
+		if (!source.read(job.frame, this->budget != NULL ? this->budget->frameStride() : 1)) {
+			std::cerr << "Stream is closed or video camera is disconnected" << std::endl;
+			break;
+		}
+		if (job.frame.empty()) {
+			std::cerr << "Error: blank frame grabbed" << std::endl;
+			continue;
+		}
+		job.seq = seq++;
+		job.position_ms = source.positionMs();
+		this->frames_read++;
+		job.roi = cv::Rect(0, 0, job.frame.cols, job.frame.rows);
+		if (this->debug != NULL)
+			job.debug = this->debug->begin(job.seq);
+		if (this->gate != NULL)
+			job.unchanged = !this->gate->check(job.frame, job.roi);
+
+		std::optional<FrameJob> evicted;
+		if (!decoded.push(std::move(job), &evicted))
+			break;
+		if (evicted) {
+			this->frames_dropped++;
+			if (this->debug != NULL)
+				this->debug->discard(evicted->debug);
+			FrameJob tombstone;
+			tombstone.seq = evicted->seq;
+			tombstone.dropped = true;
+			located.push(std::move(tombstone));
+		}
+	}
+	decoded.close();
+}
+
+/** Beskrivning:  Lokaliseringssteget, letar kandidater med locateCandidates() i den del av bildrutan som ändrats. Flera trådar kan köra detta steg samtidigt
+* Argument 1:   BoundedQueue<FrameJob>& - kö från avkodningssteget
+* Argument 2:   BoundedQueue<FrameJob>& - kö till ocr steget
+* Return:       void
+* Exempel:
+*               locate(decoded, located) => körs tills avkodningskön är stängd och tom
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Pipeline::locate(BoundedQueue<FrameJob> &decoded, BoundedQueue<FrameJob> &located) {
+	DetectionContext detection; // One per detection thread
+	detection.processing_width = this->config.processing_width;
+	detection.bands = this->config.bands;
+	FrameJob job;
+	while (decoded.pop(job)) {
+		if (this->budget != NULL) {
+			detection.processing_width = this->budget->processingWidth();
+			detection.keep = this->budget->candidates();
+		}
+		if (!job.unchanged) {
+			auto start = std::chrono::steady_clock::now();
+			detection.debug = job.debug;
+			job.candidates = locateCandidatesInRegion(job.frame, job.roi, detection);
+			job.locate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+		if (!located.push(std::move(job)))
+			break;
+	}
+}
+
+/** Beskrivning:  Ocr steget, sorterar tillbaka bildrutorna i ordning och kör extract_ids() på dem. Kandidaterna i en bildruta
+*									körs parallellt av OcrPool
+* Argument 1:   BoundedQueue<FrameJob>& - kö från lokaliseringssteget
+* Argument 2:   BoundedQueue<FrameJob>& - kö till utritningssteget
+* Return:       void
+* Exempel:
+*               recognize(located, recognized) => körs tills lokaliseringskön är stängd och tom
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Pipeline::recognize(BoundedQueue<FrameJob> &located, BoundedQueue<FrameJob> &recognized) {
+	std::map<long, FrameJob> pending; // Reorder buffer, detection workers may finish out of order
+	long next_seq = 0;
+	FrameJob job;
+	while (located.pop(job)) {
+		pending.emplace(job.seq, std::move(job));
+		for (auto it = pending.find(next_seq); it != pending.end(); it = pending.find(next_seq)) {
+			FrameJob current = std::move(it->second);
+			pending.erase(it);
+			next_seq++;
+			if (current.dropped)
+				continue;
+
+			if (current.unchanged) {
+				// Nothing moved, the previous result still holds
+				current.matches		= this->gate->held_matches;
+				current.candidates	= this->gate->held_candidates;
+				current.parking_valid	= this->gate->held_parking_valid;
+				current.id_valid	= this->gate->held_id_valid;
+			} else {
+				auto start = std::chrono::steady_clock::now();
+				if (this->tracker != NULL)
+					this->tracker->limitTo(current.roi);
+				current.matches = extract_ids(this->ocr, current.frame, current.candidates, this->known_cars, this->tracker, current.debug);
+				current.ocr_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (this->gate != NULL) {
+					// Plates outside the part that moved keep their previous result
+					this->gate->hold(current.roi, current.matches, current.candidates);
+				}
+				for (Match &match : current.matches) {
+					if (match.parking_valid)
+						current.parking_valid = true;
+					if (match.id_valid)
+						current.id_valid = true;
+				}
+			}
+			if (!recognized.push(std::move(current)))
+				break;
+		}
+	}
+	recognized.close();
+}
+
+/** Beskrivning:  Startar alla steg i pipelinen och kör utritningssteget i den anroppande tråden, eftersom fönster i OpenCV
+*									måste hanteras från samma tråd. Returnerar när strömmen är slut eller on_frame returnerar false
+* Argument 1:   FrameSource& - referens till en öppen videoström och dess sampling, får veta i utritningssteget ifall en skylt lästes
+* Argument 2:   std::function<bool(FrameJob&)> - anroppas i ordning för varje färdig bildruta, returnera false för att avbryta
+* Return:       void
+* Exempel:
+*               pipeline.run(source, [](FrameJob &job) { cv::imshow("Frame", job.frame); return true; }) => visar varje bildruta
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void Pipeline::run(FrameSource &source, std::function<bool(FrameJob&)> on_frame) {
+	BoundedQueue<FrameJob> decoded(this->config.queue_size, this->config.backpressure);
+	BoundedQueue<FrameJob> located(this->config.queue_size, Backpressure::BLOCK);
+	BoundedQueue<FrameJob> recognized(this->config.queue_size, Backpressure::BLOCK);
+
+	std::thread decoder(&Pipeline::decode, this, std::ref(source), std::ref(decoded), std::ref(located));
+	std::vector<std::thread> locators;
+	for (int i = 0; i < this->config.detect_threads; i++)
+		locators.emplace_back(&Pipeline::locate, this, std::ref(decoded), std::ref(located));
+	std::thread recognizer(&Pipeline::recognize, this, std::ref(located), std::ref(recognized));
+
+	/* When every detection worker is done the ocr step gets nothing more */
+	std::thread closer([&] {
+		for (std::thread &locator : locators)
+			locator.join();
+		located.close();
+	});
+
+	FrameJob job;
+	while (recognized.pop(job)) {
+		double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.start).count();
+		METRICS.frame.observe(latency);
+		// The budget only sees the work it controls, waits in the queues and in on_frame are not detection or ocr time
+		if (this->budget != NULL && !job.unchanged)
+			this->budget->observe(job.locate_ms + job.ocr_ms, job.locate_ms, job.ocr_ms);
+		METRICS.frames.add();
+		source.observe(job.id_valid);
+		METRICS.queue_decoded.set(decoded.size());
+		METRICS.queue_located.set(located.size());
+		METRICS.queue_recognized.set(recognized.size());
+		if (this->debug != NULL)
+			this->debug->end(job.debug, job.frame, job.matches, job.candidates);
+		if (!on_frame(job)) {
+			this->stopping = true;
+			decoded.close();
+			located.close();
+			recognized.close();
+			break;
+		}
+	}
+
+	decoder.join();
+	closer.join();
+	recognizer.join();
+}
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "known_cars.hpp"
+#include "plate_classifier.hpp"
+
+#define GLYPH_MAX_DISTANCE 0.8f	// Characters further than this from every learned character are not trusted, the glyphs have unit length
+
+/** Beskrivning:  Konstruktor som skapar en tom modell, den läses in med load() eller byggs upp med add()
+* Argument 1:   float - lägsta säkerhet för att ett svar ska användas
+* Return:       PlateClassifier - PlateClassifier objekt
+* Exempel:
+*               PlateClassifier classifier(0.25f) => classifier.size() = 0
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+PlateClassifier::PlateClassifier(float min_confidence_in) {
+	this->min_confidence = min_confidence_in;
+}
+
+/** Beskrivning:  Läser in en modell sparad med save(), en modell med annan teckenstorlek godtas inte
+* Argument 1:   const std::string& - sökväg till modellen
+* Return:       bool - true ifall modellen kunde läsas
+* Exempel:
+*               classifier.load("ocr_model.yml") => true och classifier.size() = antal inlärda tecken
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool PlateClassifier::load(const std::string &path) {
+	cv::FileStorage fs(path, cv::FileStorage::READ);
+	if (!fs.isOpened())
+		return false;
+
+	int width = 0, height = 0;
+	std::string labels_in;
+	cv::Mat samples_in;
+	fs["glyph_width"] >> width;
+	fs["glyph_height"] >> height;
+	fs["labels"] >> labels_in;
+	fs["samples"] >> samples_in;
+	if (width != GLYPH_WIDTH || height != GLYPH_HEIGHT || samples_in.type() != CV_32F ||
+	    samples_in.cols != GLYPH_WIDTH * GLYPH_HEIGHT || samples_in.rows != (int) labels_in.size())
+		return false;
+
+	this->samples = samples_in;
+	this->labels = labels_in;
+	return true;
+}
+
+/** Beskrivning:  Sparar modellen som YAML eller XML beroende på filändelsen
+* Argument 1:   const std::string& - sökväg att spara till
+* Return:       bool - true ifall filen kunde skrivas
+* Exempel:
+*               classifier.save("ocr_model.yml") => true
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool PlateClassifier::save(const std::string &path) const {
+	cv::FileStorage fs(path, cv::FileStorage::WRITE);
+	if (!fs.isOpened())
+		return false;
+	fs << "glyph_width" << GLYPH_WIDTH;
+	fs << "glyph_height" << GLYPH_HEIGHT;
+	fs << "labels" << this->labels;
+	fs << "samples" << this->samples;
+	return true;
+}
+
+/** Beskrivning:  Lär in ett tecken, glyph ska komma från segment_plate()
+* Argument 1:   const cv::Mat& - normaliserat tecken, en rad med GLYPH_WIDTH * GLYPH_HEIGHT flyttal
+* Argument 2:   char - vilket tecken det är
+* Return:       void
+* Exempel:
+*               classifier.add(glyphs[0], 'Y') => classifier.size() ökar med ett
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void PlateClassifier::add(const cv::Mat &glyph, char label) {
+	this->samples.push_back(glyph);
+	this->labels += label;
+}
+
+/** Beskrivning:  Letar upp det närmaste inlärda tecknet. Säkerheten jämför avståndet till närmaste klass med avståndet till den näst närmaste klassen,
+*									1 när inget annat tecken är i närheten och 0 när två klasser är lika nära
+* Argument 1:   const cv::Mat& - normaliserat tecken från segment_plate()
+* Argument 2:   float& - referens där säkerheten sparas
+* Return:       char - närmaste tecken, 0 ifall modellen är tom
+* Exempel:
+*               classifier.nearest(glyphs[0], confidence) => 'Y' och confidence = 0.6
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+char PlateClassifier::nearest(const cv::Mat &glyph, float &confidence) const {
+	float class_best[256];
+	std::fill(class_best, class_best + 256, FLT_MAX);
+	for (int i = 0; i < this->samples.rows; i++) {
+		unsigned char label = this->labels[i];
+		float distance = (float) cv::norm(glyph, this->samples.row(i), cv::NORM_L2SQR);
+		class_best[label] = std::min(class_best[label], distance);
+	}
+
+	int first = -1, second = -1;
+	for (int c = 0; c < 256; c++) {
+		if (class_best[c] == FLT_MAX)
+			continue;
+		if (first < 0 || class_best[c] < class_best[first]) {
+			second = first;
+			first = c;
+		} else if (second < 0 || class_best[c] < class_best[second]) {
+			second = c;
+		}
+	}
+	confidence = 0;
+	if (first < 0)
+		return 0;
+
+	float best = std::sqrt(class_best[first]);
+	if (best <= GLYPH_MAX_DISTANCE)
+		confidence = second < 0 ? 1.0f : 1.0f - best / std::max(FLT_MIN, std::sqrt(class_best[second]));
+	return (char) first;
+}
+
+/** Beskrivning:  Läser en registreringsskylt från ett utklipp. Lyckas bara när utklippet delas upp i exakt PLATE_LENGTH tecken och varje tecken
+*									är minst så säkert som min_confidence, annars ska svaret tas från Tesseract
+* Argument 1:   const cv::Mat& - utklipp av en kandidat, färg eller gråskala
+* Argument 2:   std::string& - referens där skylten sparas, tom ifall klassificeringen inte lyckades
+* Argument 3:   float* - pekare där det osäkraste tecknets säkerhet sparas, eller NULL
+* Return:       bool - true ifall answer kan användas
+* Exempel:
+*               classifier.classify(crop, answer) => true och answer = "YAJ066"
+*               classifier.classify(blurry, answer) => false och answer = ""
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool PlateClassifier::classify(const cv::Mat &crop, std::string &answer, float *confidence) const {
+	answer = "";
+	if (confidence != NULL)
+		*confidence = 0;
+	if (this->samples.empty())
+		return false;
+
+	std::vector<cv::Mat> glyphs;
+	if (segment_plate(crop, glyphs) != PLATE_LENGTH)
+		return false;
+
+	std::string read;
+	float lowest = 1.0f;
+	for (const cv::Mat &glyph : glyphs) {
+		float glyph_confidence;
+		read += this->nearest(glyph, glyph_confidence);
+		lowest = std::min(lowest, glyph_confidence);
+	}
+	if (confidence != NULL)
+		*confidence = lowest;
+	if (lowest < this->min_confidence)
+		return false;
+	answer = read;
+	return true;
+}
+
+/** Beskrivning:  Delar upp ett utklipp av en registreringsskylt i tecken från vänster till höger. Utklippet skalas till SEGMENT_HEIGHT och tröskas med Otsu,
+*									sedan behålls de sammanhängande komponenter som är höga, smala och ungefär lika höga som de andra. Ramen och landsbandet
+*									sorteras bort eftersom de når kanten eller har en annan höjd. Varje tecken skalas till GLYPH_WIDTH x GLYPH_HEIGHT med längden 1
+* Argument 1:   const cv::Mat& - utklipp av en kandidat, färg eller gråskala
+* Argument 2:   std::vector<cv::Mat>& - referens där tecknen sparas, en rad med flyttal per tecken
+* Return:       size_t - antal tecken som hittades
+* Exempel:
+*               segment_plate(crop, glyphs) => 6 för en tydlig skylt
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+size_t segment_plate(const cv::Mat &crop, std::vector<cv::Mat> &glyphs) {
+	glyphs.clear();
+	if (crop.empty())
+		return 0;
+
+	cv::Mat gray, scaled, binary, labels, stats, centroids;
+	if (crop.channels() == 3)
+		cv::cvtColor(crop, gray, cv::COLOR_BGR2GRAY);
+	else if (crop.channels() == 4)
+		cv::cvtColor(crop, gray, cv::COLOR_BGRA2GRAY);
+	else
+		gray = crop;
+	int width = std::max(1, cvRound(crop.cols * (double) SEGMENT_HEIGHT / crop.rows));
+	cv::resize(gray, scaled, cv::Size(width, SEGMENT_HEIGHT), 0, 0, cv::INTER_LINEAR);
+	cv::threshold(scaled, binary, 0, 255, cv::THRESH_BINARY_INV | cv::THRESH_OTSU); // Dark characters on a light plate become white
+	int count = cv::connectedComponentsWithStats(binary, labels, stats, centroids, 8, CV_32S);
+
+	// Characters are tall and narrow, and unlike the plate frame they do not reach the top or bottom edge
+	std::vector<int> parts;
+	for (int i = 1; i < count; i++) {
+		int y = stats.at<int>(i, cv::CC_STAT_TOP);
+		int w = stats.at<int>(i, cv::CC_STAT_WIDTH);
+		int h = stats.at<int>(i, cv::CC_STAT_HEIGHT);
+		int area = stats.at<int>(i, cv::CC_STAT_AREA);
+		if (h < SEGMENT_HEIGHT * 0.35 || h > SEGMENT_HEIGHT * 0.95)
+			continue;
+		if (w < 2 || w > h)
+			continue;
+		if (y == 0 || y + h >= SEGMENT_HEIGHT)
+			continue;
+		if (area < 0.15 * w * h)
+			continue; // Outlines and thin lines
+		parts.push_back(i);
+	}
+	if (parts.empty())
+		return 0;
+
+	// Stray marks and the country band differ in height from the characters
+	std::vector<int> heights;
+	for (int part : parts)
+		heights.push_back(stats.at<int>(part, cv::CC_STAT_HEIGHT));
+	std::nth_element(heights.begin(), heights.begin() + heights.size() / 2, heights.end());
+	int median = heights[heights.size() / 2];
+	parts.erase(std::remove_if(parts.begin(), parts.end(), [&](int part) {
+				return std::abs(stats.at<int>(part, cv::CC_STAT_HEIGHT) - median) > median * 0.2;
+			}), parts.end());
+	std::sort(parts.begin(), parts.end(), [&](int a, int b) {
+			return stats.at<int>(a, cv::CC_STAT_LEFT) < stats.at<int>(b, cv::CC_STAT_LEFT);
+		});
+
+	for (int part : parts) {
+		cv::Rect box(stats.at<int>(part, cv::CC_STAT_LEFT), stats.at<int>(part, cv::CC_STAT_TOP),
+			stats.at<int>(part, cv::CC_STAT_WIDTH), stats.at<int>(part, cv::CC_STAT_HEIGHT));
+		cv::Mat mask = labels(box) == part; // Only this component, not parts of its neighbours inside the box
+		cv::Mat glyph;
+		cv::resize(mask, glyph, cv::Size(GLYPH_WIDTH, GLYPH_HEIGHT), 0, 0, cv::INTER_AREA);
+		glyph.convertTo(glyph, CV_32F, 1.0 / 255);
+		double length = cv::norm(glyph);
+		if (length > 0)
+			glyph /= length;
+		glyphs.push_back(glyph.reshape(1, 1));
+	}
+	return glyphs.size();
+}
@@ -0,0 +1,647 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "event_writer.hpp"
+#include "plate_log.hpp"
+
+/** Beskrivning:  Packar en skylt till ett heltal med sex bitar per tecken, 0-9 och A-Z, så att en post har fast storlek och skyltar jämförs som tal
+* Argument 1:   const std::string& - skylten, högst tio tecken
+* Return:       uint64_t - packad skylt, 0 för en tom skylt eller en med andra tecken
+* Exempel:
+*               pack_plate("YAJ066") => 0x8cb5011c7
+*               pack_plate("") => 0
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+uint64_t pack_plate(const std::string &plate) {
+	if (plate.empty() || plate.size() > 10)
+		return 0;
+	uint64_t packed = 0;
+	for (char c : plate) {
+		uint64_t code;
+		if (c >= '0' && c <= '9')
+			code = 1 + (c - '0');
+		else if (c >= 'A' && c <= 'Z')
+			code = 11 + (c - 'A');
+		else
+			return 0;
+		packed = packed << 6 | code;
+	}
+	return packed;
+}
+
+/** Beskrivning:  Packar upp en skylt från pack_plate()
+* Argument 1:   uint64_t - packad skylt
+* Return:       std::string - skylten, tom för 0
+* Exempel:
+*               unpack_plate(pack_plate("YAJ066")) => "YAJ066"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string unpack_plate(uint64_t packed) {
+	std::string plate;
+	for (; packed != 0; packed >>= 6) {
+		int code = packed & 0x3f;
+		plate.insert(plate.begin(), code <= 10 ? (char) ('0' + code - 1) : (char) ('A' + code - 11));
+	}
+	return plate;
+}
+
+/** Beskrivning:  Sökväg till en fil i ett segment, numret har sex siffror så att filerna sorteras i ordning
+* Argument 1:   const std::string& - katalogen
+* Argument 2:   uint32_t - segmentets nummer
+* Argument 3:   const char* - filändelse, ".log" eller ".idx"
+* Return:       std::string - sökvägen
+* Exempel:
+*               segment_path("plates", 3, ".log") => "plates/000003.log"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static std::string segment_path(const std::string &directory, uint32_t number, const char *extension) {
+	char name[32];
+	snprintf(name, sizeof(name), "/%06u%s", number, extension);
+	return directory + name;
+}
+
+/** Beskrivning:  Skriver hela bufferten till en fil, även när write() bara skriver en del åt gången
+* Argument 1:   int - fildeskriptor
+* Argument 2:   const void* - data
+* Argument 3:   size_t - antal byte
+* Return:       bool - false vid fel
+* Exempel:
+*               write_all(fd, records.data(), records.size() * sizeof(PlateRecord)) => true
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static bool write_all(int fd, const void *data, size_t size) {
+	const char *bytes = (const char*) data;
+	while (size > 0) {
+		ssize_t written = ::write(fd, bytes, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		bytes += written;
+		size -= written;
+	}
+	return true;
+}
+
+/** Beskrivning:  Minnesmappar en fil för läsning
+* Argument 1:   const std::string& - sökväg
+* Argument 2:   size_t& - referens där filens storlek sparas
+* Return:       const void* - början av filen, eller NULL ifall den saknas eller är tom
+* Exempel:
+*               map_file("plates/000003.idx", size) => pekare till size byte
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static const void* map_file(const std::string &path, size_t &size) {
+	size = 0;
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		::close(fd);
+		return NULL;
+	}
+	void *data = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // The mapping keeps the file
+	if (data == MAP_FAILED)
+		return NULL;
+	size = info.st_size;
+	return data;
+}
+
+/** Beskrivning:  Läser numren på alla segment som har en logg i katalogen
+* Argument 1:   const std::string& - katalogen
+* Return:       std::vector<uint32_t> - numren i stigande ordning
+* Exempel:
+*               log_segments("plates") => [1, 2, 3]
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static std::vector<uint32_t> log_segments(const std::string &directory) {
+	std::vector<uint32_t> numbers;
+	std::error_code error;
+	for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.path().extension() != ".log")
+			continue;
+		std::string stem = entry.path().stem().string();
+		if (!stem.empty() && std::all_of(stem.begin(), stem.end(), [](char c) { return c >= '0' && c <= '9'; }))
+			numbers.push_back((uint32_t) std::stoul(stem));
+	}
+	std::sort(numbers.begin(), numbers.end());
+	return numbers;
+}
+
+/** Beskrivning:  Läser en tidpunkt i UTC, antingen sekunder sedan 1970 eller ISO 8601 med valfria sekunder och Z
+* Argument 1:   const char* - tidpunkten
+* Argument 2:   int64_t& - referens där mikrosekunder sedan 1970 sparas
+* Return:       bool - false ifall tidpunkten inte kunde läsas
+* Exempel:
+*               parse_time("2026-10-17T08:30", us) => true, us = 1792225800000000
+*               parse_time("1792225800", us) => true, samma tid
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool parse_time(const char *value, int64_t &time_us) {
+	char *end;
+	long long seconds = strtoll(value, &end, 10);
+	if (*value != '\0' && *end == '\0') {
+		time_us = (int64_t) seconds * 1000000;
+		return true;
+	}
+	struct tm parts = {};
+	int read = 0;
+	if (sscanf(value, "%d-%d-%dT%d:%d%n", &parts.tm_year, &parts.tm_mon, &parts.tm_mday, &parts.tm_hour, &parts.tm_min, &read) != 5)
+		return false;
+	value += read;
+	if (sscanf(value, ":%d%n", &parts.tm_sec, &read) == 1)
+		value += read;
+	if (*value == 'Z')
+		value++;
+	if (*value != '\0')
+		return false;
+	parts.tm_year -= 1900;
+	parts.tm_mon -= 1;
+	time_us = (int64_t) timegm(&parts) * 1000000;
+	return true;
+}
+
+/** Beskrivning:  Läser segments.idx
+* Argument 1:   const std::string& - katalogen
+* Return:       std::vector<PlateSegmentEntry> - de förseglade segmenten i den ordning de förseglades
+* Exempel:
+*               sealed_segments("plates") => [{1, ...}, {2, ...}]
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static std::vector<PlateSegmentEntry> sealed_segments(const std::string &directory) {
+	std::vector<PlateSegmentEntry> segments;
+	std::ifstream file(directory + "/segments.idx", std::ios::binary);
+	PlateSegmentEntry entry;
+	while (file.read((char*) &entry, sizeof(entry)))
+		segments.push_back(entry);
+	return segments;
+}
+
+/** Beskrivning:  Konstruktor som skapar katalogen, låser den, läser strömmarnas namn och förseglar segment som lämnades öppna. Det första
+*									segmentet öppnas först när något ska skrivas. Låset gör att en andra process aldrig tar ett levande segment för ett
+*									som lämnades efter en krasch. En ofullständig post i slutet av segments.idx kapas bort innan den läses
+* Argument 1:   PlateLogConfig - katalog och storlek på segmenten
+* Return:       PlateLog - PlateLog objekt
+* Exempel:
+*               PlateLog log(config) => log.ok() är true ifall katalogen går att skriva i och ingen annan process skriver i den
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+PlateLog::PlateLog(PlateLogConfig config_in) {
+	this->config = config_in;
+	this->config.segment_records = std::max(1L, this->config.segment_records);
+	std::error_code error;
+	std::filesystem::create_directories(this->config.directory, error);
+	if (error) {
+		std::cerr << "Cannot create " << this->config.directory << ": " << error.message() << std::endl;
+		return;
+	}
+	std::string lock = this->config.directory + "/lock";
+	this->lock_fd = ::open(lock.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (this->lock_fd < 0) {
+		std::cerr << "Cannot open " << lock << ": " << strerror(errno) << std::endl;
+		return;
+	}
+	if (flock(this->lock_fd, LOCK_EX | LOCK_NB) != 0) {
+		if (errno == EWOULDBLOCK)
+			std::cerr << this->config.directory << " is written by another process, give every process a directory of its own" << std::endl;
+		else
+			std::cerr << "Cannot lock " << lock << ": " << strerror(errno) << std::endl;
+		return;
+	}
+
+	std::ifstream names(this->config.directory + "/streams.txt");
+	std::string name;
+	while (std::getline(names, name))
+		this->streams.emplace(name, (uint32_t) this->streams.size() + 1);
+
+	// A torn append from a crash would misalign every entry sealed after it, the partial entry is cut off like in recover()
+	std::string segments = this->config.directory + "/segments.idx";
+	uintmax_t segments_size = std::filesystem::file_size(segments, error);
+	if (!error && segments_size % sizeof(PlateSegmentEntry) != 0) {
+		std::cerr << "Cutting a partial entry off " << segments << std::endl;
+		std::filesystem::resize_file(segments, segments_size - segments_size % sizeof(PlateSegmentEntry), error);
+	}
+	error.clear();
+
+	std::set<uint32_t> sealed;
+	for (const PlateSegmentEntry &segment : sealed_segments(this->config.directory)) {
+		sealed.insert(segment.number);
+		this->number = std::max(this->number, segment.number);
+	}
+	for (uint32_t number : log_segments(this->config.directory)) {
+		if (sealed.count(number) == 0)
+			this->recover(number);
+		this->number = std::max(this->number, number);
+	}
+	this->good = true;
+	this->sealer = std::thread(&PlateLog::sealOnTime, this);
+}
+
+/** Beskrivning:  Destruktor som förseglar det öppna segmentet och släpper låset på katalogen
+* Return:       void
+* Exempel:
+*               delete log => det sista segmentet har ett index
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+PlateLog::~PlateLog() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	if (this->sealer.joinable())
+		this->sealer.join();
+	this->seal();
+	if (this->lock_fd >= 0)
+		::close(this->lock_fd); // Releases the lock
+}
+
+/** Beskrivning:  Tråd som förseglar det öppna segmentet när det är config.segment_seconds gammalt, så att en kamera som inte ser något
+*									inte lämnar sina senaste poster utan index
+* Return:       void
+* Exempel:
+*               std::thread(&PlateLog::sealOnTime, this) => körs tills destruktorn
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void PlateLog::sealOnTime() {
+	std::chrono::seconds age(std::max(1, this->config.segment_seconds));
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (!this->stopping) {
+		if (this->fd < 0) {
+			this->wake.wait(lock); // write() wakes the thread when it opens a segment
+			continue;
+		}
+		if (std::chrono::steady_clock::now() - this->opened >= age) {
+			this->seal();
+			continue;
+		}
+		this->wake.wait_until(lock, this->opened + age);
+	}
+}
+
+/** Beskrivning:  Ger numret för en ström, nya namn läggs till sist i streams.txt. En tom ström, en enda video, har nummer 0
+* Argument 1:   const std::string& - strömmens namn
+* Return:       uint32_t - raden i streams.txt
+* Exempel:
+*               streamId("entrance") => 1 första gången, och sedan alltid 1
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+uint32_t PlateLog::streamId(const std::string &name) {
+	if (name.empty())
+		return 0;
+	auto found = this->streams.find(name);
+	if (found != this->streams.end())
+		return found->second;
+	std::string line = name;
+	std::replace(line.begin(), line.end(), '\n', ' ');
+	std::ofstream names(this->config.directory + "/streams.txt", std::ios::app);
+	names << line << "\n";
+	return this->streams.emplace(name, (uint32_t) this->streams.size() + 1).first->second;
+}
+
+/** Beskrivning:  Öppnar ett nytt segment att skriva till
+* Argument 1:   uint32_t - segmentets nummer
+* Return:       bool - false ifall loggen inte kunde skapas
+* Exempel:
+*               open(4) => "plates/000004.log" är öppen
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool PlateLog::open(uint32_t number_in) {
+	std::string path = segment_path(this->config.directory, number_in, ".log");
+	this->fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (this->fd < 0) {
+		std::cerr << "Cannot open " << path << ": " << strerror(errno) << std::endl;
+		return false;
+	}
+	this->number = number_in;
+	this->records = 0;
+	this->index.clear();
+	return true;
+}
+
+/** Beskrivning:  Förseglar segmentet: loggen synkas till disk, indexet sorteras och skrivs, och segmentet läggs till i segments.idx.
+*									Indexet skrivs till en temporär fil som döps om, så en läsare ser aldrig ett halvt index
+* Return:       void
+* Exempel:
+*               seal() => "plates/000004.idx" finns och segments.idx har en post till
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void PlateLog::seal() {
+	if (this->fd >= 0) {
+		fsync(this->fd);
+		::close(this->fd);
+		this->fd = -1;
+	}
+	if (this->records == 0)
+		return;
+
+	std::sort(this->index.begin(), this->index.end(), [](const PlateIndexEntry &a, const PlateIndexEntry &b) {
+		if (a.plate != b.plate)
+			return a.plate < b.plate;
+		if (a.time_us != b.time_us)
+			return a.time_us < b.time_us;
+		return a.record < b.record;
+	});
+	std::string path = segment_path(this->config.directory, this->number, ".idx");
+	std::string temporary = path + ".tmp";
+	int out = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	bool written = out >= 0 && write_all(out, this->index.data(), this->index.size() * sizeof(PlateIndexEntry)) && fsync(out) == 0;
+	if (out >= 0)
+		::close(out);
+	if (!written || rename(temporary.c_str(), path.c_str()) != 0) {
+		std::cerr << "Cannot write " << path << ": " << strerror(errno) << std::endl;
+		return;
+	}
+
+	PlateSegmentEntry segment = {};
+	segment.number	= this->number;
+	segment.first_us	= this->first_us;
+	segment.last_us	= this->last_us;
+	segment.records	= this->records;
+	std::string segments = this->config.directory + "/segments.idx";
+	out = ::open(segments.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (out < 0 || !write_all(out, &segment, sizeof(segment)))
+		std::cerr << "Cannot write " << segments << ": " << strerror(errno) << std::endl;
+	if (out >= 0) {
+		fsync(out);
+		::close(out);
+	}
+	this->records = 0;
+	this->index.clear();
+}
+
+/** Beskrivning:  Förseglar ett segment som lämnades öppet, till exempel efter en krasch. En ofullständig post i slutet kapas bort.
+*									Det här är det enda stället där en logg läses i sin helhet
+* Argument 1:   uint32_t - segmentets nummer
+* Return:       void
+* Exempel:
+*               recover(3) => "plates/000003.idx" finns
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void PlateLog::recover(uint32_t number_in) {
+	std::string path = segment_path(this->config.directory, number_in, ".log");
+	std::error_code error;
+	uintmax_t size = std::filesystem::file_size(path, error);
+	if (error)
+		return;
+	if (size % sizeof(PlateRecord) != 0)
+		std::filesystem::resize_file(path, size - size % sizeof(PlateRecord), error);
+
+	this->number = number_in;
+	this->records = 0;
+	this->index.clear();
+	std::ifstream file(path, std::ios::binary);
+	PlateRecord record;
+	while (file.read((char*) &record, sizeof(record))) {
+		if (this->records == 0 || record.time_us < this->first_us)
+			this->first_us = record.time_us;
+		if (this->records == 0 || record.time_us > this->last_us)
+			this->last_us = record.time_us;
+		if (record.plate != 0)
+			this->index.push_back({record.plate, record.time_us, (uint32_t) this->records, 0});
+		this->records++;
+	}
+	if (this->records == 0) {
+		std::filesystem::remove(path, error);
+		return;
+	}
+	std::cerr << "Sealing " << path << " with " << this->records << " records left open" << std::endl;
+	this->seal();
+}
+
+/** Beskrivning:  Skriver alla matchningar i en bildruta som poster i slutet av det öppna segmentet med en enda write(). Bildrutor utan
+*									matchningar skrivs inte. Segmentet förseglas först ifall posterna inte får plats eller det är för gammalt.
+*									Posternas tid är bildrutans tid för fångst när den är känd, annars tiden då de skrivs
+* Argument 1:   const FrameEvent& - bildrutans ström, nummer, position och eventuell tid för fångst
+* Argument 2:   const std::vector<Match>& - bildrutans matchningar
+* Return:       void
+* Exempel:
+*               log.write(event, matches) => tre poster till för en bildruta med tre matchningar
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void PlateLog::write(const FrameEvent &event, const std::vector<Match> &matches) {
+	if (matches.empty())
+		return;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (!this->good)
+		return;
+	int64_t time_us = event.capture_us;
+	if (time_us == 0)
+		time_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	uint32_t stream = this->streamId(event.stream);
+
+	this->batch.clear();
+	for (const Match &match : matches) {
+		if (this->config.valid_only && !match.id_valid)
+			continue;
+		PlateRecord record = {};
+		record.time_us		= time_us;
+		record.frame		= event.frame;
+		record.position_ms	= event.position_ms;
+		record.plate		= match.id_valid ? pack_plate(match.id) : 0;
+		record.x		= match.rectangle.x;
+		record.y		= match.rectangle.y;
+		record.width		= match.rectangle.width;
+		record.height		= match.rectangle.height;
+		record.stream		= stream;
+		record.flags		= (match.id_valid ? PLATE_ID_VALID : 0) | (match.parking_valid ? PLATE_PARKING_VALID : 0)
+					| (event.capture_us != 0 ? PLATE_CAPTURE_TIME : 0);
+		this->batch.push_back(record);
+	}
+	if (this->batch.empty())
+		return;
+
+	if (this->fd >= 0 && (this->records + this->batch.size() > (uint64_t) this->config.segment_records
+			|| std::chrono::steady_clock::now() - this->opened >= std::chrono::seconds(this->config.segment_seconds)))
+		this->seal();
+	if (this->fd < 0) {
+		if (!this->open(this->number + 1)) {
+			this->good = false;
+			return;
+		}
+		this->opened = std::chrono::steady_clock::now();
+		this->wake.notify_all();
+	}
+	if (!write_all(this->fd, this->batch.data(), this->batch.size() * sizeof(PlateRecord))) {
+		std::cerr << "Cannot write to the plate log: " << strerror(errno) << std::endl;
+		this->good = false;
+		return;
+	}
+	// Capture times of archived footage or several cameras need not arrive in order, the segment covers all of them
+	if (this->records == 0 || time_us < this->first_us)
+		this->first_us = time_us;
+	if (this->records == 0 || time_us > this->last_us)
+		this->last_us = time_us;
+	for (const PlateRecord &record : this->batch) {
+		if (record.plate != 0)
+			this->index.push_back({record.plate, record.time_us, (uint32_t) this->records, 0});
+		this->records++;
+	}
+}
+
+/** Beskrivning:  Konstruktor som läser strömmarnas namn och minnesmappar segments.idx
+* Argument 1:   const std::string& - katalogen
+* Return:       PlateLogReader - PlateLogReader objekt
+* Exempel:
+*               PlateLogReader reader("plates") => reader.ok() är true ifall katalogen finns
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+PlateLogReader::PlateLogReader(const std::string &directory_in) {
+	this->directory = directory_in;
+	if (!std::filesystem::is_directory(this->directory))
+		return;
+	this->stream_names.push_back("");
+	std::ifstream names(this->directory + "/streams.txt");
+	std::string name;
+	while (std::getline(names, name))
+		this->stream_names.push_back(name);
+
+	this->segments = (const PlateSegmentEntry*) map_file(this->directory + "/segments.idx", this->mapped_size);
+	this->segment_count = this->mapped_size / sizeof(PlateSegmentEntry); // A writer may be appending, a partial entry is left out
+
+	std::set<uint32_t> sealed;
+	for (size_t i = 0; i < this->segment_count; i++)
+		sealed.insert(this->segments[i].number);
+	for (uint32_t number : log_segments(this->directory)) {
+		if (sealed.count(number) == 0)
+			this->open_segments.push_back(number);
+	}
+	this->good = true;
+}
+
+/** Beskrivning:  Destruktor som tar bort minnesmappningen
+* Return:       void
+* Exempel:
+*               delete reader
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+PlateLogReader::~PlateLogReader() {
+	if (this->segments != NULL)
+		munmap((void*) this->segments, this->mapped_size);
+}
+
+/** Beskrivning:  Namnet på en ström från dess nummer i posterna
+* Argument 1:   uint32_t - strömmens nummer
+* Return:       std::string - namnet, tomt för en enda video eller ett okänt nummer
+* Exempel:
+*               reader.streamName(1) => "entrance"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string PlateLogReader::streamName(uint32_t stream) const {
+	return stream < this->stream_names.size() ? this->stream_names[stream] : "";
+}
+
+/** Beskrivning:  Letar upp varje gång en skylt sågs i ett tidsintervall. Segment utanför intervallet hoppas över med segments.idx, och i de andra
+*									binärsöks det minnesmappade indexet efter skylten och starttiden. Endast de poster som matchar läses ur loggen.
+*									Öppna segment har inget index och läses bara igenom ifall scan_open är satt
+* Argument 1:   uint64_t - packad skylt från pack_plate()
+* Argument 2:   int64_t - början av intervallet, mikrosekunder sedan 1970 UTC
+* Argument 3:   int64_t - slutet av intervallet, ingår
+* Argument 4:   std::function<void(const PlateRecord&)> - anroppas för varje post, i tidsordning inom varje segment
+* Argument 5:   bool - true för att även läsa igenom öppna segment
+* Return:       long - antal poster
+* Exempel:
+*               reader.find(pack_plate("YAJ066"), 0, INT64_MAX, print) => 12
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+long PlateLogReader::find(uint64_t plate, int64_t from_us, int64_t to_us, std::function<void(const PlateRecord&)> on_record, bool scan_open) {
+	long found = 0;
+	PlateRecord record;
+	for (size_t i = 0; i < this->segment_count; i++) {
+		const PlateSegmentEntry &segment = this->segments[i];
+		if (segment.last_us < from_us || segment.first_us > to_us)
+			continue;
+
+		size_t size;
+		const PlateIndexEntry *index = (const PlateIndexEntry*) map_file(segment_path(this->directory, segment.number, ".idx"), size);
+		if (index == NULL)
+			continue;
+		const PlateIndexEntry *end = index + size / sizeof(PlateIndexEntry);
+		const PlateIndexEntry *it = std::lower_bound(index, end, std::make_pair(plate, from_us), [](const PlateIndexEntry &entry, const std::pair<uint64_t, int64_t> &key) {
+			return entry.plate != key.first ? entry.plate < key.first : entry.time_us < key.second;
+		});
+		int fd = -1;
+		for (; it != end && it->plate == plate && it->time_us <= to_us; it++) {
+			if (fd < 0)
+				fd = ::open(segment_path(this->directory, segment.number, ".log").c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+				break;
+			if (pread(fd, &record, sizeof(record), (off_t) it->record * sizeof(record)) != sizeof(record))
+				continue;
+			on_record(record);
+			found++;
+		}
+		if (fd >= 0)
+			::close(fd);
+		munmap((void*) index, size);
+	}
+
+	for (uint32_t number : this->open_segments) {
+		if (!scan_open)
+			break;
+		std::ifstream file(segment_path(this->directory, number, ".log"), std::ios::binary);
+		while (file.read((char*) &record, sizeof(record))) {
+			if (record.plate == plate && record.time_us >= from_us && record.time_us <= to_us) {
+				on_record(record);
+				found++;
+			}
+		}
+	}
+	return found;
+}
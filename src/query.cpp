@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <time.h>
+#include <cinttypes>
+#include <climits>
+#include <iostream>
+#include <string>
+#include "anpr.hpp"
+
+enum class QueryFormat {
+	TEXT,	// One aligned line per sighting
+	JSON,	// One JSON object per sighting and line
+	CSV	// Header and one row per sighting
+};
+
+struct {
+	std::string plate;
+	int64_t from_us = INT64_MIN;
+	int64_t to_us = INT64_MAX;
+	std::string stream;
+	bool any_stream = true;
+	QueryFormat format = QueryFormat::TEXT;
+	bool scan_open = false;
+} QUERY_FLAGS;
+
+/** Beskrivning:  Skriver en tidpunkt som ISO 8601 i UTC med millisekunder
+* Argument 1:   int64_t - mikrosekunder sedan 1970
+* Return:       std::string - tidpunkten
+* Exempel:
+*               format_time(1792225800250000) => "2026-10-17T08:30:00.250Z"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static std::string format_time(int64_t time_us) {
+	time_t seconds = time_us / 1000000;
+	struct tm parts;
+	gmtime_r(&seconds, &parts);
+	char text[40];
+	size_t length = strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &parts);
+	snprintf(text + length, sizeof(text) - length, ".%03dZ", (int) (time_us % 1000000 / 1000));
+	return text;
+}
+
+/** Beskrivning:  Skriver en post i det valda formatet
+* Argument 1:   const PlateLogReader& - läsaren, för strömmens namn
+* Argument 2:   const PlateRecord& - posten
+* Return:       void
+* Exempel:
+*               print_record(reader, record) => 2026-10-17T08:30:00.250Z  entrance  YAJ066  frame 1200  48000ms  [412,300 120x32] valid parked
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static void print_record(const PlateLogReader &reader, const PlateRecord &record) {
+	std::string time = format_time(record.time_us);
+	std::string stream = reader.streamName(record.stream);
+	std::string plate = unpack_plate(record.plate);
+	bool id_valid = record.flags & PLATE_ID_VALID;
+	bool parking_valid = record.flags & PLATE_PARKING_VALID;
+	switch (QUERY_FLAGS.format) {
+	case QueryFormat::JSON:
+		printf("{\"time\":\"%s\",\"stream\":\"%s\",\"plate\":\"%s\",\"frame\":%" PRId64 ",\"time_ms\":%.0f,\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,"
+			"\"id_valid\":%s,\"parking_valid\":%s}\n", time.c_str(), json_escape(stream).c_str(), plate.c_str(), record.frame, record.position_ms,
+			record.x, record.y, record.width, record.height, id_valid ? "true" : "false", parking_valid ? "true" : "false");
+		break;
+	case QueryFormat::CSV:
+		printf("%s,%s,%s,%" PRId64 ",%.0f,%d,%d,%d,%d,%d,%d\n", time.c_str(), csv_escape(stream).c_str(), plate.c_str(), record.frame, record.position_ms,
+			record.x, record.y, record.width, record.height, id_valid, parking_valid);
+		break;
+	case QueryFormat::TEXT:
+	default:
+		printf("%s  %-12s  %-10s  frame %-8" PRId64 "  %.0fms  [%d,%d %dx%d]%s%s\n", time.c_str(), stream.empty() ? "-" : stream.c_str(), plate.c_str(),
+			record.frame, record.position_ms, record.x, record.y, record.width, record.height, id_valid ? " valid" : "", parking_valid ? " parked" : "");
+		break;
+	}
+}
+
+/** Beskrivning:  Slår upp när en skylt sågs i en PlateLog katalog som main skrev med --plate-log. Sökningen använder de minnesmappade indexen
+*									och läser bara de poster som matchar. Segmentet som fortfarande skrivs har inget index och läses bara med --open
+* Argument 1:   int - antal argument
+* Argument 2:   char** - katalogen och --plate=skylt, samt valfria flaggor: --from=tid, --to=tid, --stream=namn, --format=text|json|csv, --open.
+*												 Tider är UTC, sekunder sedan 1970 eller 2026-10-17T08:30:00
+* Return:       int - 0 ifall skylten hittades, 1 ifall den inte gjorde det och 2 vid fel
+* Exempel:
+*               ./anpr_query plates --plate=YAJ066 --from=2026-10-17T00:00 --format=json
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int main(int argc, char** argv) {
+	std::string directory;
+	for (int i = 1; i < argc; i++) {
+		const char *value;
+		if ((value = flag_value(argv[i], "--plate="))) {
+			QUERY_FLAGS.plate = value;
+		} else if ((value = flag_value(argv[i], "--from="))) {
+			if (!parse_time(value, QUERY_FLAGS.from_us)) {
+				std::cerr << "Unknown time: " << value << std::endl;
+				return 2;
+			}
+		} else if ((value = flag_value(argv[i], "--to="))) {
+			if (!parse_time(value, QUERY_FLAGS.to_us)) {
+				std::cerr << "Unknown time: " << value << std::endl;
+				return 2;
+			}
+		} else if ((value = flag_value(argv[i], "--stream="))) {
+			QUERY_FLAGS.stream = value;
+			QUERY_FLAGS.any_stream = false;
+		} else if ((value = flag_value(argv[i], "--format="))) {
+			if (strcmp(value, "text") == 0) {
+				QUERY_FLAGS.format = QueryFormat::TEXT;
+			} else if (strcmp(value, "json") == 0) {
+				QUERY_FLAGS.format = QueryFormat::JSON;
+			} else if (strcmp(value, "csv") == 0) {
+				QUERY_FLAGS.format = QueryFormat::CSV;
+			} else {
+				std::cerr << "Unknown output format: " << value << std::endl;
+			}
+		} else if (strcmp(argv[i], "--open") == 0) {
+			QUERY_FLAGS.scan_open = true;
+		} else if (strncmp(argv[i], "--", 2) != 0) {
+			directory = argv[i];
+		} else {
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
+		}
+	}
+	if (directory.empty() || QUERY_FLAGS.plate.empty()) {
+		std::cerr << "Please pass the plate log directory and --plate=" << std::endl;
+		return 2;
+	}
+	uint64_t plate = pack_plate(QUERY_FLAGS.plate);
+	if (plate == 0) {
+		std::cerr << "A plate is at most 10 characters 0-9 and A-Z: " << QUERY_FLAGS.plate << std::endl;
+		return 2;
+	}
+
+	PlateLogReader reader(directory);
+	if (!reader.ok()) {
+		std::cerr << "Cannot read plate log " << directory << std::endl;
+		return 2;
+	}
+	if (QUERY_FLAGS.format == QueryFormat::CSV)
+		printf("time,stream,plate,frame,time_ms,x,y,width,height,id_valid,parking_valid\n");
+	long found = 0;
+	reader.find(plate, QUERY_FLAGS.from_us, QUERY_FLAGS.to_us, [&](const PlateRecord &record) {
+		if (!QUERY_FLAGS.any_stream && reader.streamName(record.stream) != QUERY_FLAGS.stream)
+			return;
+		print_record(reader, record);
+		found++;
+	}, QUERY_FLAGS.scan_open);
+
+	std::cerr << "Searched " << reader.segmentCount() << " indexed segments, " << found << " sightings";
+	if (!reader.openSegments().empty())
+		std::cerr << (QUERY_FLAGS.scan_open ? ", scanned " : ", skipped ") << reader.openSegments().size() << " open segment(s)"
+			<< (QUERY_FLAGS.scan_open ? "" : " (use --open)");
+	std::cerr << std::endl;
+	return found > 0 ? 0 : 1;
+}
@@ -0,0 +1,355 @@
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <sys/resource.h>
+#include <vector>
+#include "anpr.hpp"
+
+struct {
+	int frames_per_image = 10;
+	int gap = 5;
+	int width = 1280;
+	int height = 720;
+	double fps = 25;
+	std::string clips = "replay";
+	bool luma = false;
+	EngineConfig engine;
+} REPLAY_FLAGS;
+
+// An image of the clip and the plates that are in it
+struct ClipImage {
+	std::string file;
+	std::vector<std::string> plates;
+};
+
+// Throughput and accuracy of one clip
+struct ReplayResult {
+	std::string clip;
+	long frames = 0;
+	double seconds = 0;
+	std::vector<double> latencies;	// Milliseconds per frame, from reading the frame to having its matches
+	long plates = 0;		// Plates in view over all frames
+	long true_positives = 0;	// Valid reads of a plate that is in view
+	long false_positives = 0;	// Valid reads of a plate that is not
+	long false_negatives = 0;	// Plates in view that were not read
+	long false_accepts = 0;		// Frames where a plate that is not in view was found in the known cars list
+};
+
+/** Beskrivning:  Den största mängden minne processen haft i RAM hittills
+* Return:       double - peak RSS i megabyte
+* Exempel:
+*               peak_rss_mb() => 182.5
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+double peak_rss_mb() {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	return usage.ru_maxrss / 1024.0; // Kilobytes on Linux
+}
+
+/** Beskrivning:  Läser sidofilen plates.txt i en katalog med en bild per rad: filnamn följt av skyltarna i bilden, eller - för en bild utan skylt.
+*									Rader som börjar med # hoppas över. Ordningen i filen är ordningen i klippet
+* Argument 1:   const std::string& - sökväg till sidofilen
+* Argument 2:   std::vector<ClipImage>& - referens där bilderna läggs till
+* Return:       bool - false ifall filen inte kunde läsas
+* Exempel:
+*               read_truth("../samples/plates.txt", images) => images[1] = {"002.jpg", {"BMW570"}}
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool read_truth(const std::string &path, std::vector<ClipImage> &images) {
+	std::ifstream file(path);
+	if (!file.is_open())
+		return false;
+	std::string line;
+	while (std::getline(file, line)) {
+		std::stringstream fields(line);
+		ClipImage image;
+		if (!(fields >> image.file) || image.file[0] == '#')
+			continue;
+		std::string plate;
+		while (fields >> plate) {
+			if (plate != "-")
+				image.plates.push_back(plate);
+		}
+		images.push_back(image);
+	}
+	return true;
+}
+
+/** Beskrivning:  Bygger ett klipp av bilderna i en katalog och skriver det som MJPEG med OpenCVs egen kodare, så att samma bilder alltid ger
+*									samma klipp. Varje bild visas i REPLAY_FLAGS.frames_per_image bildrutor med en långsam zoom så att bildrutorna
+*									inte är identiska, följt av REPLAY_FLAGS.gap tomma grå bildrutor. Skyltarna för varje bildruta sparas i truth
+* Argument 1:   const std::string& - katalog med bilderna och plates.txt
+* Argument 2:   const std::string& - sökväg till klippet som skrivs
+* Argument 3:   std::vector<std::vector<std::string>>& - referens där skyltarna läggs till, en lista per bildruta
+* Return:       bool - false ifall sidofilen inte kunde läsas eller klippet inte kunde skrivas
+* Exempel:
+*               build_clip("../samples", "replay/samples.avi", truth) => true, 90 bildrutor med 10 bildrutor per bild och 5 tomma
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool build_clip(const std::string &directory, const std::string &path, std::vector<std::vector<std::string>> &truth) {
+	std::vector<ClipImage> images;
+	if (!read_truth(directory + "/plates.txt", images)) {
+		std::cerr << "Cannot read " << directory << "/plates.txt" << std::endl;
+		return false;
+	}
+	cv::Size size(REPLAY_FLAGS.width, REPLAY_FLAGS.height);
+	cv::VideoWriter writer(path, cv::CAP_OPENCV_MJPEG, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), REPLAY_FLAGS.fps, size);
+	if (!writer.isOpened()) {
+		std::cerr << "Cannot write " << path << std::endl;
+		return false;
+	}
+
+	cv::Mat fitted, frame;
+	cv::Mat empty(size, CV_8UC3, cv::Scalar(128, 128, 128));
+	for (ClipImage &image : images) {
+		cv::Mat original = cv::imread(directory + "/" + image.file);
+		if (original.empty()) {
+			std::cerr << "Cannot read " << directory << "/" << image.file << std::endl;
+			continue;
+		}
+		// Scaled to fit once with INTER_AREA, so the zoom below only moves the pixels a little
+		double fit = std::min(size.width / (double) original.cols, size.height / (double) original.rows);
+		cv::resize(original, fitted, cv::Size(std::max(1, cvRound(original.cols * fit)), std::max(1, cvRound(original.rows * fit))), 0, 0, cv::INTER_AREA);
+		for (int i = 0; i < REPLAY_FLAGS.frames_per_image; i++) {
+			double zoom = 1 + 0.05 * i / REPLAY_FLAGS.frames_per_image;
+			cv::Mat transform = (cv::Mat_<double>(2, 3) <<
+				zoom, 0, (size.width - fitted.cols * zoom) / 2,
+				0, zoom, (size.height - fitted.rows * zoom) / 2);
+			cv::warpAffine(fitted, frame, transform, size, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+			writer.write(frame);
+			truth.push_back(image.plates);
+		}
+		for (int i = 0; i < REPLAY_FLAGS.gap; i++) {
+			writer.write(empty);
+			truth.push_back({});
+		}
+	}
+	writer.release();
+	return true;
+}
+
+/** Beskrivning:  Kör ett klipp genom hela detektorn, FrameSource och Engine::process() utan fönster, och jämför varje bildrutas giltiga
+*									läsningar med skyltarna i bildrutan
+* Argument 1:   Engine& - referens till motorn
+* Argument 2:   const std::string& - sökväg till klippet
+* Argument 3:   std::vector<std::vector<std::string>>& - referens till skyltarna i varje bildruta
+* Argument 4:   ReplayResult& - referens där tider och träffar sparas
+* Return:       bool - false ifall klippet inte kunde öppnas
+* Exempel:
+*               replay(engine, "replay/samples.avi", truth, result) => result.frames = 90
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool replay(Engine &engine, const std::string &path, std::vector<std::vector<std::string>> &truth, ReplayResult &result) {
+	cv::VideoCapture cap(path);
+	if (!cap.isOpened())
+		return false;
+	FrameSource source(cap, SamplingConfig(), REPLAY_FLAGS.luma);
+	cv::Mat frame;
+
+	auto run_start = std::chrono::steady_clock::now();
+	while (true) {
+		auto start = std::chrono::steady_clock::now();
+		if (!source.read(frame))
+			break;
+		std::vector<Match> matches = engine.process(frame);
+		result.latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		result.frames++;
+
+		long index = source.framesGrabbed() - 1;
+		std::set<std::string> expected;
+		if (index >= 0 && index < (long) truth.size())
+			expected.insert(truth[index].begin(), truth[index].end());
+		std::set<std::string> read;
+		bool false_accept = false;
+		for (const Match &match : matches) {
+			if (match.id_valid)
+				read.insert(match.id);
+			if (match.parking_valid && expected.count(match.id) == 0)
+				false_accept = true;
+		}
+		for (const std::string &plate : read) {
+			if (expected.count(plate))
+				result.true_positives++;
+			else
+				result.false_positives++;
+		}
+		for (const std::string &plate : expected) {
+			if (read.count(plate) == 0)
+				result.false_negatives++;
+		}
+		result.plates += expected.size();
+		if (false_accept)
+			result.false_accepts++;
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+	source.report(std::cerr);
+	return true;
+}
+
+/** Beskrivning:  Formaterar en kvot för JSON, null när nämnaren är noll
+* Argument 1:   long - täljare
+* Argument 2:   long - nämnare
+* Return:       std::string - kvoten med fyra decimaler, eller "null"
+* Exempel:
+*               json_ratio(3, 4) => "0.7500"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string json_ratio(long numerator, long denominator) {
+	if (denominator == 0)
+		return "null";
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.4f", numerator / (double) denominator);
+	return buffer;
+}
+
+/** Beskrivning:  Skriver ut resultatet för ett klipp som en JSON rad
+* Argument 1:   ReplayResult& - referens till resultatet
+* Return:       void
+* Exempel:
+*               print_result(result) => {"clip":"samples","frames":90,"fps":21.4,"p50_ms":41.2,"p99_ms":88.0,"peak_rss_mb":182.5,"plates":60,...}
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void print_result(ReplayResult &result) {
+	std::vector<double> sorted = result.latencies;
+	std::sort(sorted.begin(), sorted.end());
+	printf("{\"clip\":\"%s\",\"frames\":%ld,\"seconds\":%.3f,\"fps\":%.2f,\"p50_ms\":%.2f,\"p99_ms\":%.2f,\"peak_rss_mb\":%.1f,"
+		"\"plates\":%ld,\"true_positives\":%ld,\"false_positives\":%ld,\"false_negatives\":%ld,\"precision\":%s,\"recall\":%s,"
+		"\"false_accepts\":%ld,\"false_accept_rate\":%s,\"luma\":%s}\n",
+		result.clip.c_str(), result.frames, result.seconds, result.seconds > 0 ? result.frames / result.seconds : 0,
+		percentile(sorted, 50), percentile(sorted, 99), peak_rss_mb(),
+		result.plates, result.true_positives, result.false_positives, result.false_negatives,
+		json_ratio(result.true_positives, result.true_positives + result.false_positives).c_str(),
+		json_ratio(result.true_positives, result.true_positives + result.false_negatives).c_str(),
+		result.false_accepts, json_ratio(result.false_accepts, result.frames).c_str(), REPLAY_FLAGS.luma ? "true" : "false");
+	fflush(stdout);
+}
+
+/** Beskrivning:  Benchmark av hela kedjan från avkodning till matchning, med både hastighet och träffsäkerhet i samma körning. Bygger ett klipp per
+*									katalog av bilderna i dess plates.txt, spelar upp klippen genom Engine utan fönster och skriver en JSON rad per klipp
+*									samt en rad med clip "*" för alla klipp. Precision och recall räknas på giltiga läsningar mot skyltarna i bildrutan,
+*									false_accept_rate är andelen bildrutor där en skylt som inte syns hittades i listan över godkänt parkerade bilar
+* Argument 1:   int - antal argument
+* Argument 2:   char** - kataloger med bilder och plates.txt, samt valfria flaggor: --known-cars=fil, --frames-per-image=N, --gap=N,
+*												 --size=BxH, --clips=katalog, --luma, --ocr-threads=N, --ocr-mode=crop|frame|montage, --ocr-model=fil,
+*												 --lang=språk, --width=N, --bands=N, --track, --motion
+* Return:       int - status kod för programmet
+* Exempel:
+*               ./anpr_replay ../samples ../demo --known-cars=../samples/known_cars.txt > replay.jsonl
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int main(int argc, char** argv) {
+	std::vector<std::string> directories;
+	REPLAY_FLAGS.engine.reload_interval = 0; // The list does not change during a run
+	for (int i = 1; i < argc; i++) {
+		const char *value;
+		if ((value = flag_value(argv[i], "--known-cars="))) {
+			REPLAY_FLAGS.engine.known_cars = value;
+		} else if ((value = flag_value(argv[i], "--frames-per-image="))) {
+			REPLAY_FLAGS.frames_per_image = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--gap="))) {
+			REPLAY_FLAGS.gap = std::max(0, atoi(value));
+		} else if ((value = flag_value(argv[i], "--size="))) {
+			if (sscanf(value, "%dx%d", &REPLAY_FLAGS.width, &REPLAY_FLAGS.height) != 2 || REPLAY_FLAGS.width < 32 || REPLAY_FLAGS.height < 32) {
+				std::cerr << "Unknown clip size: " << value << std::endl;
+				return 1;
+			}
+		} else if ((value = flag_value(argv[i], "--clips="))) {
+			REPLAY_FLAGS.clips = value;
+		} else if (strcmp(argv[i], "--luma") == 0) {
+			REPLAY_FLAGS.luma = true;
+		} else if ((value = flag_value(argv[i], "--ocr-threads="))) {
+			REPLAY_FLAGS.engine.ocr.size = std::max(1, atoi(value));
+		} else if ((value = flag_value(argv[i], "--ocr-mode="))) {
+			if (strcmp(value, "crop") == 0) {
+				REPLAY_FLAGS.engine.ocr.mode = OcrMode::CROP;
+			} else if (strcmp(value, "frame") == 0) {
+				REPLAY_FLAGS.engine.ocr.mode = OcrMode::FRAME;
+			} else if (strcmp(value, "montage") == 0) {
+				REPLAY_FLAGS.engine.ocr.mode = OcrMode::MONTAGE;
+			} else {
+				std::cerr << "Unknown ocr mode: " << value << std::endl;
+			}
+		} else if ((value = flag_value(argv[i], "--ocr-model="))) {
+			REPLAY_FLAGS.engine.ocr.model = value;
+		} else if ((value = flag_value(argv[i], "--lang="))) {
+			REPLAY_FLAGS.engine.ocr.language = value;
+		} else if ((value = flag_value(argv[i], "--width="))) {
+			REPLAY_FLAGS.engine.processing_width = std::max(32, atoi(value));
+		} else if ((value = flag_value(argv[i], "--bands="))) {
+			REPLAY_FLAGS.engine.bands = std::max(0, atoi(value));
+		} else if (strcmp(argv[i], "--track") == 0) {
+			REPLAY_FLAGS.engine.track = true;
+		} else if (strcmp(argv[i], "--motion") == 0) {
+			REPLAY_FLAGS.engine.motion = true;
+		} else if (strncmp(argv[i], "--", 2) != 0) {
+			directories.push_back(argv[i]);
+		} else {
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
+		}
+	}
+	if (directories.empty()) {
+		std::cerr << "Please pass directories with images and plates.txt" << std::endl;
+		return 1;
+	}
+	std::error_code error;
+	std::filesystem::create_directories(REPLAY_FLAGS.clips, error);
+
+	ReplayResult total;
+	total.clip = "*";
+	for (std::string &directory : directories) {
+		ReplayResult result;
+		result.clip = std::filesystem::path(directory).lexically_normal().filename().string();
+		if (result.clip.empty())
+			result.clip = std::filesystem::path(directory).lexically_normal().parent_path().filename().string();
+		std::string path = REPLAY_FLAGS.clips + "/" + result.clip + ".avi";
+
+		std::vector<std::vector<std::string>> truth;
+		if (!build_clip(directory, path, truth))
+			continue;
+
+		/* Every clip gets an engine of its own, tracks, background and budget from the last clip would change its score */
+		Engine engine(REPLAY_FLAGS.engine);
+		if (!engine.ok()) {
+			fprintf(stderr, "Could not initialize tesseract or the ocr model.\n");
+			return 1;
+		}
+		if (!replay(engine, path, truth, result)) {
+			std::cerr << "Cannot open " << path << std::endl;
+			continue;
+		}
+		print_result(result);
+		engine.report(std::cerr);
+
+		total.frames		+= result.frames;
+		total.seconds		+= result.seconds;
+		total.plates		+= result.plates;
+		total.true_positives	+= result.true_positives;
+		total.false_positives	+= result.false_positives;
+		total.false_negatives	+= result.false_negatives;
+		total.false_accepts	+= result.false_accepts;
+		total.latencies.insert(total.latencies.end(), result.latencies.begin(), result.latencies.end());
+	}
+	print_result(total);
+	return 0;
+}
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <signal.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "anpr.hpp"
+
+struct {
+	ShmRingConfig ring;
+	ShmFormat format = ShmFormat::BGR24;
+	double fps = 25;			// 0 for as fast as the source decodes
+	bool loop = false;
+} PRODUCER_FLAGS;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+/** Beskrivning:  Packar en färgbild som NV12, Y planet följt av U och V varvade i halv upplösning, så som många avkodare lämnar bildrutor
+* Argument 1:   const cv::Mat& - referens till bilden i BGR, bredd och höjd avrundas nedåt till jämna tal
+* Argument 2:   std::vector<uint8_t>& - referens där bilden sparas
+* Return:       void
+* Exempel:
+*               to_nv12(frame, nv12) => nv12 är 1280 * 1080 byte för en bild i 1280x720
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static void to_nv12(const cv::Mat &frame, std::vector<uint8_t> &nv12) {
+	cv::Mat even = frame(cv::Rect(0, 0, frame.cols & ~1, frame.rows & ~1));
+	cv::Mat i420;
+	cv::cvtColor(even, i420, cv::COLOR_BGR2YUV_I420);
+	size_t pixels = (size_t) even.cols * even.rows;
+	nv12.resize(pixels * 3 / 2);
+	memcpy(nv12.data(), i420.data, pixels);
+	const uint8_t *u = i420.data + pixels;
+	const uint8_t *v = u + pixels / 4;
+	for (size_t i = 0; i < pixels / 4; i++) {
+		nv12[pixels + 2 * i] = u[i];
+		nv12[pixels + 2 * i + 1] = v[i];
+	}
+}
+
+/** Beskrivning:  Testproducent för ringbufferten i delat minne, spelar upp en video, kamera eller bild i den takt en fångstprocess skulle
+*									lämna bildrutor så att main --shm=namn kan provas på en maskin. Bildrutorna skrivs utan att vänta på läsaren,
+*									en läsare som inte hinner med hoppar över bildrutor
+* Argument 1:   int - antal argument
+* Argument 2:   char** - namnet på det delade minnet och en video, kamera eller bild, samt valfria flaggor: --fps=F, --format=gray|bgr|nv12,
+*												 --slots=N, --max-size=BxH, --loop
+* Return:       int - status kod för programmet
+* Exempel:
+*               ./anpr_shm_producer cam0 ../samples/002.mp4 --fps=25 --format=nv12 --loop
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int main(int argc, char** argv) {
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; i++) {
+		const char *value;
+		if ((value = flag_value(argv[i], "--fps="))) {
+			PRODUCER_FLAGS.fps = std::max(0.0, atof(value));
+		} else if ((value = flag_value(argv[i], "--format="))) {
+			if (strcmp(value, "gray") == 0) {
+				PRODUCER_FLAGS.format = ShmFormat::GRAY8;
+			} else if (strcmp(value, "bgr") == 0) {
+				PRODUCER_FLAGS.format = ShmFormat::BGR24;
+			} else if (strcmp(value, "nv12") == 0) {
+				PRODUCER_FLAGS.format = ShmFormat::NV12;
+			} else {
+				std::cerr << "Unknown frame format: " << value << std::endl;
+			}
+		} else if ((value = flag_value(argv[i], "--slots="))) {
+			PRODUCER_FLAGS.ring.slots = std::max(SHM_RING_MIN_SLOTS, atoi(value));
+		} else if ((value = flag_value(argv[i], "--max-size="))) {
+			if (sscanf(value, "%dx%d", &PRODUCER_FLAGS.ring.max_width, &PRODUCER_FLAGS.ring.max_height) != 2)
+				std::cerr << "Unknown size: " << value << std::endl;
+		} else if (strcmp(argv[i], "--loop") == 0) {
+			PRODUCER_FLAGS.loop = true;
+		} else if (strncmp(argv[i], "--", 2) != 0) {
+			positional.push_back(argv[i]);
+		} else {
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
+		}
+	}
+	if (positional.size() < 2) {
+		std::cerr << "Please pass the shared memory name and a video, camera or image" << std::endl;
+		return 1;
+	}
+	PRODUCER_FLAGS.ring.name = positional[0];
+
+	/* A still image is sent over and over, anything else is opened as a video */
+	cv::Mat still = cv::imread(positional[1], cv::IMREAD_COLOR);
+	cv::VideoCapture cap;
+	if (still.empty()) {
+		const std::string &source = positional[1];
+		bool device = !source.empty() && source.find_first_not_of("0123456789") == std::string::npos;
+		if (device ? !cap.open(atoi(source.c_str())) : !cap.open(source)) {
+			std::cerr << "Cannot open " << source << std::endl;
+			return 1;
+		}
+	}
+
+	ShmProducer producer(PRODUCER_FLAGS.ring);
+	if (!producer.ok())
+		return 1;
+	signal(SIGINT, [](int) { stop_requested = 1; });
+	signal(SIGTERM, [](int) { stop_requested = 1; });
+	std::cerr << "Writing to " << shm_object_name(PRODUCER_FLAGS.ring.name) << ", stop with ctrl-c" << std::endl;
+
+	auto interval = std::chrono::duration<double>(PRODUCER_FLAGS.fps > 0 ? 1.0 / PRODUCER_FLAGS.fps : 0);
+	auto next = std::chrono::steady_clock::now();
+	cv::Mat frame, gray;
+	std::vector<uint8_t> nv12;
+	while (!stop_requested) {
+		if (!still.empty()) {
+			frame = still;
+		} else if (!cap.read(frame)) {
+			if (!PRODUCER_FLAGS.loop || !cap.set(cv::CAP_PROP_POS_FRAMES, 0) || !cap.read(frame))
+				break;
+		}
+		int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		bool published;
+		switch (PRODUCER_FLAGS.format) {
+		case ShmFormat::GRAY8:
+			cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+			published = producer.publish(gray.data, gray.cols, gray.rows, gray.step, ShmFormat::GRAY8, now_us);
+			break;
+		case ShmFormat::NV12:
+			to_nv12(frame, nv12);
+			published = producer.publish(nv12.data(), frame.cols & ~1, frame.rows & ~1, frame.cols & ~1, ShmFormat::NV12, now_us);
+			break;
+		case ShmFormat::BGR24:
+		default:
+			published = producer.publish(frame.data, frame.cols, frame.rows, frame.step, ShmFormat::BGR24, now_us);
+			break;
+		}
+		if (!published) {
+			std::cerr << "A " << frame.cols << "x" << frame.rows << " frame does not fit, raise --max-size" << std::endl;
+			break;
+		}
+
+		next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+		std::this_thread::sleep_until(next);
+	}
+
+	std::cerr << "Published " << producer.framesPublished() << " frames" << std::endl;
+	return 0;
+}
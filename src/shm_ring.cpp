@@ -0,0 +1,320 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <opencv2/opencv.hpp>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "shm_ring.hpp"
+
+/** Beskrivning:  Gör ett namn till namnet på ett POSIX objekt för delat minne, som måste börja med /
+* Argument 1:   const std::string& - namnet, med eller utan /
+* Return:       std::string - namnet med /
+* Exempel:
+*               shm_object_name("cam0") => "/cam0"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string shm_object_name(const std::string &name) {
+	return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+/** Beskrivning:  Räknar ut hur en bild ligger i en plats, för NV12 följer U och V planet efter Y planet med samma radlängd
+* Argument 1:   int - bredd
+* Argument 2:   int - höjd
+* Argument 3:   ShmFormat - format
+* Argument 4:   size_t& - referens där antal byte per rad sparas
+* Return:       int - antal rader
+* Exempel:
+*               image_rows(1280, 720, ShmFormat::NV12, row) => 1080 rader med row = 1280
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static int image_rows(int width, int height, ShmFormat format, size_t &row) {
+	switch (format) {
+	case ShmFormat::BGR24:
+		row = (size_t) width * 3;
+		return height;
+	case ShmFormat::NV12:
+		row = width;
+		return height + (height + 1) / 2;
+	case ShmFormat::GRAY8:
+	default:
+		row = width;
+		return height;
+	}
+}
+
+/** Beskrivning:  Konstruktor som skapar objektet för delat minne med config.slots platser stora nog för en BGR24 bild i största storleken.
+*									Ett gammalt objekt med samma namn tas bort först, en läsare som har det öppet behåller sin mappning
+* Argument 1:   ShmRingConfig - namn, antal platser och största bildstorlek
+* Return:       ShmProducer - ShmProducer objekt
+* Exempel:
+*               ShmProducer producer(config) => "/dev/shm/cam0" med fyra platser för 1920x1080
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+ShmProducer::ShmProducer(ShmRingConfig config_in) {
+	this->config = config_in;
+	this->config.slots = std::max(SHM_RING_MIN_SLOTS, std::min(this->config.slots, 0xffff));
+	this->object = shm_object_name(this->config.name);
+	uint64_t slot_size = (sizeof(ShmSlotHeader) + (uint64_t) this->config.max_width * this->config.max_height * 3 + 63) & ~(uint64_t) 63;
+	size_t size = SHM_RING_HEADER_SIZE + slot_size * this->config.slots;
+
+	shm_unlink(this->object.c_str());
+	int fd = shm_open(this->object.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		std::cerr << "Cannot create shared memory " << this->object << ": " << strerror(errno) << std::endl;
+		return;
+	}
+	if (ftruncate(fd, size) != 0) {
+		std::cerr << "Cannot size shared memory " << this->object << ": " << strerror(errno) << std::endl;
+		::close(fd);
+		shm_unlink(this->object.c_str());
+		return;
+	}
+	void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd); // The mapping keeps the object
+	if (memory == MAP_FAILED) {
+		shm_unlink(this->object.c_str());
+		return;
+	}
+
+	/* ftruncate zeroed everything, the magic is written last so a reader never sees a half made header */
+	ShmRingHeader *header = (ShmRingHeader*) memory;
+	header->version = SHM_RING_VERSION;
+	header->slot_count = this->config.slots;
+	header->slot_size = slot_size;
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = SHM_RING_MAGIC;
+	this->memory = (uint8_t*) memory;
+	this->size = size;
+	this->slot = this->config.slots - 1; // The first frame goes to slot 0
+}
+
+/** Beskrivning:  Destruktor som markerar ringen som stängd så att läsaren slutar vänta, och tar bort objektet
+* Return:       void
+* Exempel:
+*               delete producer => source.read(frame) returnerar false när den sista bildrutan är läst
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+ShmProducer::~ShmProducer() {
+	if (this->memory == NULL)
+		return;
+	((ShmRingHeader*) this->memory)->closed.store(1);
+	munmap(this->memory, this->size);
+	shm_unlink(this->object.c_str());
+}
+
+/** Beskrivning:  Kopierar en bildruta till den äldsta platsen som läsaren inte håller och gör den till den nyaste. Väntar aldrig på läsaren
+* Argument 1:   const uint8_t* - pekare till bilden, för NV12 Y planet följt av UV planet med samma radlängd
+* Argument 2:   int - bredd
+* Argument 3:   int - höjd
+* Argument 4:   size_t - bytes mellan raderna i data
+* Argument 5:   ShmFormat - format
+* Argument 6:   int64_t - tidpunkt då bildrutan fångades, mikrosekunder
+* Return:       bool - false ifall bilden inte får plats i en plats
+* Exempel:
+*               producer.publish(frame.data, 1280, 720, frame.step, ShmFormat::BGR24, now_us) => true
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool ShmProducer::publish(const uint8_t *data, int width, int height, size_t step, ShmFormat format, int64_t timestamp_us) {
+	ShmRingHeader *header = (ShmRingHeader*) this->memory;
+	size_t row;
+	int rows = image_rows(width, height, format, row);
+	if (this->memory == NULL || width <= 0 || height <= 0 || sizeof(ShmSlotHeader) + row * rows > header->slot_size)
+		return false;
+
+	/* Claim the next slot, unless the reader holds it. Both sides store before they load, so they cannot both miss each other */
+	uint32_t slot = this->slot;
+	ShmSlotHeader *target;
+	while (true) {
+		slot = (slot + 1) % header->slot_count;
+		target = (ShmSlotHeader*) (this->memory + SHM_RING_HEADER_SIZE + slot * header->slot_size);
+		uint64_t previous = target->state.load(std::memory_order_relaxed);
+		target->state.store(previous | 1);
+		if (header->reader_slot.load() != slot + 1)
+			break;
+		target->state.store(previous);
+	}
+
+	this->frame++;
+	target->frame = this->frame;
+	target->timestamp_us = timestamp_us;
+	target->width = width;
+	target->height = height;
+	target->stride = row;
+	target->format = (uint32_t) format;
+	uint8_t *image = (uint8_t*) (target + 1);
+	if (step == row) {
+		memcpy(image, data, row * rows);
+	} else {
+		for (int y = 0; y < rows; y++)
+			memcpy(image + y * row, data + y * step, row);
+	}
+	target->state.store(2 * this->frame, std::memory_order_release);
+	header->latest.store((this->frame << 16) | slot, std::memory_order_release);
+	this->slot = slot;
+	return true;
+}
+
+/** Beskrivning:  Konstruktor som öppnar och mappar ringen som producenten skapat och kontrollerar att den har rätt format
+* Argument 1:   const std::string& - namnet på det delade minnet
+* Argument 2:   bool - true för att alltid lämna en kanal
+* Argument 3:   int - millisekunder utan ny bildruta innan read() ger upp, 0 för att vänta för evigt
+* Return:       ShmSource - ShmSource objekt
+* Exempel:
+*               ShmSource source("cam0") => source.ok() = false ifall producenten inte har startat
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+ShmSource::ShmSource(const std::string &name, bool luma_in, int timeout_ms_in) {
+	this->object = shm_object_name(name);
+	this->luma = luma_in;
+	this->timeout_ms = timeout_ms_in;
+	int fd = shm_open(this->object.c_str(), O_RDWR | O_CLOEXEC, 0);
+	if (fd < 0)
+		return;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t) info.st_size < SHM_RING_HEADER_SIZE) {
+		::close(fd);
+		return;
+	}
+	void *memory = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED)
+		return;
+
+	ShmRingHeader *header = (ShmRingHeader*) memory;
+	bool valid = header->magic == SHM_RING_MAGIC;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	valid = valid && header->version == SHM_RING_VERSION && header->slot_count >= SHM_RING_MIN_SLOTS
+		&& header->slot_size >= sizeof(ShmSlotHeader) && SHM_RING_HEADER_SIZE + header->slot_size * header->slot_count <= (uint64_t) info.st_size;
+	if (!valid) {
+		std::cerr << "Shared memory " << this->object << " is not an anpr frame ring of version " << SHM_RING_VERSION << std::endl;
+		munmap(memory, info.st_size);
+		return;
+	}
+	this->memory = (uint8_t*) memory;
+	this->size = info.st_size;
+}
+
+/** Beskrivning:  Destruktor som lämnar tillbaka platsen och tar bort mappningen
+* Return:       void
+* Exempel:
+*               delete source
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+ShmSource::~ShmSource() {
+	if (this->memory == NULL)
+		return;
+	this->release();
+	munmap(this->memory, this->size);
+}
+
+/** Beskrivning:  Lämnar tillbaka platsen för den senaste bildrutan till producenten, bilden från read() får inte användas efter det
+* Return:       void
+* Exempel:
+*               source.release()
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void ShmSource::release() {
+	if (!this->holding)
+		return;
+	this->header()->reader_slot.store(0);
+	this->holding = false;
+}
+
+/** Beskrivning:  Väntar på en bildruta nyare än den förra och lämnar den nyaste. Platsen hålls tills nästa read() eller release(), så bilden
+*									ligger kvar i det delade minnet medan den körs. Med BGR24 och luma konverteras bilden, annars kopieras inget
+* Argument 1:   cv::Mat& - referens där bilden sätts, pekar in i det delade minnet
+* Return:       bool - false när producenten har stängt ringen eller ingen ny bildruta kom inom tidsgränsen
+* Exempel:
+*               source.read(frame) => true och frame är 1280x720 med tre kanaler för en BGR24 ström
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool ShmSource::read(cv::Mat &frame) {
+	if (this->memory == NULL)
+		return false;
+	this->release();
+	ShmRingHeader *header = this->header();
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(this->timeout_ms);
+	while (true) {
+		uint64_t latest = header->latest.load(std::memory_order_acquire);
+		uint64_t number = latest >> 16;
+		uint32_t slot = latest & 0xffff;
+		if (number > this->last_frame && slot < header->slot_count) {
+			/* Hold the slot, then check that the producer did not start on it first */
+			ShmSlotHeader *source = (ShmSlotHeader*) (this->memory + SHM_RING_HEADER_SIZE + slot * header->slot_size);
+			header->reader_slot.store(slot + 1);
+			if (source->state.load() == 2 * number) {
+				this->holding = true;
+				size_t row;
+				int rows = image_rows(source->width, source->height, (ShmFormat) source->format, row);
+				if (source->stride != row || sizeof(ShmSlotHeader) + row * rows > header->slot_size) {
+					std::cerr << "Frame " << number << " in " << this->object << " does not fit its slot" << std::endl;
+					this->release();
+					this->last_frame = number;
+					continue;
+				}
+				if (this->last_frame > 0)
+					this->frames_skipped += number - this->last_frame - 1;
+				this->last_frame = number;
+				this->timestamp_us = source->timestamp_us;
+				this->frames_read++;
+
+				uint8_t *image = (uint8_t*) (source + 1);
+				if ((ShmFormat) source->format == ShmFormat::BGR24) {
+					frame = cv::Mat(source->height, source->width, CV_8UC3, image, source->stride);
+					if (this->luma) {
+						cv::cvtColor(frame, this->converted, cv::COLOR_BGR2GRAY);
+						frame = this->converted;
+						this->frames_converted++;
+					}
+				} else {
+					frame = cv::Mat(source->height, source->width, CV_8UC1, image, source->stride); // GRAY8, or the Y plane of NV12
+				}
+				return true;
+			}
+			header->reader_slot.store(0); // Overwritten while we looked, a newer frame is on its way
+			continue;
+		}
+		if (header->closed.load())
+			return false;
+		if (this->timeout_ms > 0 && std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::microseconds(SHM_POLL_US));
+	}
+}
+
+/** Beskrivning:  Skriver ut hur många bildrutor som lästes, hoppades över och konverterades
+* Argument 1:   std::ostream& - ström att skriva till
+* Return:       void
+* Exempel:
+*               source.report(std::cout) => "Shared memory /cam0: read 1500 frames, skipped 12 overwritten, converted 0 to luma"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void ShmSource::report(std::ostream &out) {
+	out << "Shared memory " << this->object << ": read " << this->frames_read << " frames, skipped " << this->frames_skipped
+		<< " overwritten, converted " << this->frames_converted << " to luma" << std::endl;
+}
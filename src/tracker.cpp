@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include "tracker.hpp"
+
+/** Beskrivning:  Konstruktor som sätter privata variabler i klassen PlateTracker
+* Argument 1:   TrackerConfig - konfiguration för spårningen
+* Return:       PlateTracker - PlateTracker objekt
+* Exempel:
+*               PlateTracker tracker(config) => skapar en tracker utan några spår
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+PlateTracker::PlateTracker(TrackerConfig config_in) {
+	this->config = config_in;
+	if (this->config.history < 1)
+		this->config.history = 1;
+}
+
+/** Beskrivning:  Letar upp ett spår utifrån dess id
+* Argument 1:   int - id för spåret
+* Return:       Track* - pekare till spåret, eller NULL ifall det inte finns
+* Exempel:
+*               find(3) => pekare till spår 3
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+Track* PlateTracker::find(int id) {
+	for (Track &track : this->tracks) {
+		if (track.id == id)
+			return &track;
+	}
+	return NULL;
+}
+
+/** Beskrivning:  Beräknar hur mycket två rektanglar överlappar, intersection over union
+* Argument 1:   const cv::Rect& - första rektangeln
+* Argument 2:   const cv::Rect& - andra rektangeln
+* Return:       float - 0 ifall de inte överlappar, 1 ifall de är identiska
+* Exempel:
+*               iou(cv::Rect(0, 0, 10, 10), cv::Rect(5, 0, 10, 10)) => 0.333
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+static float iou(const cv::Rect &a, const cv::Rect &b) {
+	int intersection = (a & b).area();
+	int total = a.area() + b.area() - intersection;
+	return total > 0 ? intersection / (float) total : 0.0f;
+}
+
+/** Beskrivning:  Kopplar ihop bildrutans kandidater med befintliga spår. Varje spårs rektangel flyttas först fram med dess hastighet,
+*									sedan paras kandidater och spår ihop i ordning efter störst överlapp. Kandidater utan spår får ett nytt spår,
+*									och spår som inte setts på config.max_missing bildrutor tas bort. Är sökningen begränsad med limitTo() räknas spår
+*									som inte ligger inom området som sedda, de kunde inte hittas på denna bildruta
+* Argument 1:   std::vector<cv::Rect>& - referens till bildrutans kandidater
+* Argument 2:   std::vector<int>& - referens till vector där id för varje kandidats spår sparas
+* Return:       void
+* Exempel:
+*               tracker.update(rectangles, track_ids) => track_ids = [0, 4] för två kandidater
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+void PlateTracker::update(std::vector<cv::Rect> &rectangles, std::vector<int> &track_ids) {
+	this->frame++;
+	track_ids.assign(rectangles.size(), -1);
+
+	// Score every pair of candidate and predicted track position
+	struct Pair { float overlap; size_t rect; size_t track; };
+	std::vector<Pair> pairs;
+	for (size_t t = 0; t < this->tracks.size(); t++) {
+		Track &track = this->tracks[t];
+		float steps = (float) (this->frame - track.last_seen);
+		cv::Rect predicted = track.rect;
+		predicted.x += cvRound(track.velocity.x * steps);
+		predicted.y += cvRound(track.velocity.y * steps);
+		for (size_t r = 0; r < rectangles.size(); r++) {
+			float overlap = iou(predicted, rectangles[r]);
+			if (overlap >= this->config.min_iou)
+				pairs.push_back({ overlap, r, t });
+		}
+	}
+	std::sort(pairs.begin(), pairs.end(), [](const Pair &a, const Pair &b) { return a.overlap > b.overlap; });
+
+	// Greedy assignment, best overlap first
+	std::vector<bool> track_taken(this->tracks.size(), false);
+	for (Pair &pair : pairs) {
+		if (track_ids[pair.rect] != -1 || track_taken[pair.track])
+			continue;
+		Track &track = this->tracks[pair.track];
+		float steps = (float) (this->frame - track.last_seen);
+		cv::Point2f moved(
+			(rectangles[pair.rect].x + rectangles[pair.rect].width / 2.0f) - (track.rect.x + track.rect.width / 2.0f),
+			(rectangles[pair.rect].y + rectangles[pair.rect].height / 2.0f) - (track.rect.y + track.rect.height / 2.0f)
+		);
+		track.velocity.x = 0.5f * track.velocity.x + 0.5f * moved.x / steps;
+		track.velocity.y = 0.5f * track.velocity.y + 0.5f * moved.y / steps;
+		track.rect = rectangles[pair.rect];
+		track.last_seen = this->frame;
+		track_taken[pair.track] = true;
+		track_ids[pair.rect] = track.id;
+	}
+
+	// Tracks outside the searched part of the frame could not have been found, they are held where they are
+	if (this->region.area() > 0) {
+		for (size_t t = 0; t < this->tracks.size(); t++) {
+			Track &track = this->tracks[t];
+			if (!track_taken[t] && (track.rect & this->region) != track.rect) {
+				track.last_seen = this->frame;
+				track.velocity = cv::Point2f(0, 0);
+			}
+		}
+		this->region = cv::Rect();
+	}
+
+	// Forget tracks that have been gone for too long
+	this->tracks.erase(std::remove_if(this->tracks.begin(), this->tracks.end(), [this](Track &track) {
+				return this->frame - track.last_seen > this->config.max_missing;
+		}), this->tracks.end()
+	);
+
+	// Start new tracks for the rest
+	for (size_t r = 0; r < rectangles.size(); r++) {
+		if (track_ids[r] != -1)
+			continue;
+		Track track;
+		track.id = this->next_id++;
+		track.rect = rectangles[r];
+		track.last_seen = this->frame;
+		this->tracks.push_back(track);
+		track_ids[r] = track.id;
+	}
+}
+
+/** Beskrivning:  Avgör ifall ett spår behöver köras genom ocr på denna bildruta. Instabila spår körs varje gång, stabila spår
+*									endast var config.reverify_interval:e bildruta
+* Argument 1:   int - id för spåret
+* Return:       bool - true ifall ocr ska köras
+* Exempel:
+*               tracker.needsOcr(0) => false för ett stabilt spår som verifierades för två bildrutor sedan
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool PlateTracker::needsOcr(int id) {
+	Track *track = this->find(id);
+	bool needed = track == NULL
+		|| track->consensus_votes < this->config.stable_votes
+		|| this->frame - track->last_ocr >= this->config.reverify_interval;
+	if (needed)
+		this->ocr_runs++;
+	else
+		this->ocr_skips++;
+	return needed;
+}
+
+/** Beskrivning:  Lägger till en ocr läsning i spårets röstning, endast de senaste config.history läsningarna räknas. Tomma läsningar
+*									räknas inte som röster men markerar ändå att spåret har verifierats
+* Argument 1:   int - id för spåret
+* Argument 2:   const std::string& - den tolkade registreringsskylten, tom ifall ingen hittades
+* Return:       std::string - spårets registreringsskylt efter röstningen
+* Exempel:
+*               tracker.vote(0, "YAJ066") => "YAJ066"
+*               tracker.vote(0, "YAJ O66") => "YAJ066" ifall "YAJ066" fortfarande har flest röster
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string PlateTracker::vote(int id, const std::string &plate) {
+	Track *track = this->find(id);
+	if (track == NULL)
+		return plate;
+
+	track->last_ocr = this->frame;
+	if (!plate.empty()) {
+		track->votes.push_back(plate);
+		if ((int) track->votes.size() > this->config.history)
+			track->votes.pop_front();
+	}
+
+	std::map<std::string, int> counts;
+	track->consensus = "";
+	track->consensus_votes = 0;
+	for (std::string &read : track->votes) {
+		int count = ++counts[read];
+		// Ties go to the most recent read
+		if (count >= track->consensus_votes) {
+			track->consensus = read;
+			track->consensus_votes = count;
+		}
+	}
+	return track->consensus;
+}
+
+/** Beskrivning:  Returnerar spårets nuvarande registreringsskylt utan att rösta
+* Argument 1:   int - id för spåret
+* Return:       std::string - registreringsskylten, tom ifall spåret saknar läsningar
+* Exempel:
+*               tracker.consensus(0) => "YAJ066"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+std::string PlateTracker::consensus(int id) {
+	Track *track = this->find(id);
+	return track == NULL ? "" : track->consensus;
+}
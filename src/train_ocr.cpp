@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <tesseract/baseapi.h>
+#include <main.hpp>
+#include "plate_classifier.hpp"
+
+struct {
+	bool suggest = false;
+	std::string language = "swe";
+	int holdout = 5;
+	float min_confidence = 0.25f;
+} TRAIN_FLAGS;
+
+// One labelled crop
+struct Example {
+	std::string path;
+	std::string label;
+};
+
+/** Beskrivning:  Läser en fil med märkta utklipp, en rad per utklipp med sökväg och skylt åtskilda av mellanslag. Rader som börjar med # hoppas över,
+*									relativa sökvägar utgår från filens katalog
+* Argument 1:   const std::string& - sökväg till filen
+* Argument 2:   std::vector<Example>& - referens där utklippen sparas
+* Return:       bool - false ifall filen inte kunde öppnas
+* Exempel:
+*               read_labels("labels.txt", examples) => examples = [{"debug/12-0-crop.jpg", "YAJ066"}, ...]
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+bool read_labels(const std::string &path, std::vector<Example> &examples) {
+	std::ifstream file(path);
+	if (!file.is_open())
+		return false;
+
+	std::filesystem::path base = std::filesystem::path(path).parent_path();
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream fields(line);
+		Example example;
+		if (!(fields >> example.path >> example.label) || !valid_chars(example.label)) {
+			std::cerr << "Skipping label line: " << line << std::endl;
+			continue;
+		}
+		if (std::filesystem::path(example.path).is_relative())
+			example.path = (base / example.path).string();
+		examples.push_back(example);
+	}
+	return true;
+}
+
+/** Beskrivning:  Kör Tesseract på alla utklipp i en katalog, till exempel de som --debug sparar som "debug/N-I-crop.jpg" eller med en annan filändelse beroende på --debug-format, och skriver en etikettfil på stdout.
+*									Utklipp som Tesseract inte kunde läsa skrivs som kommentarer, etiketterna ska gås igenom för hand innan träning
+* Argument 1:   const std::string& - katalog med utklipp
+* Return:       int - status kod för programmet
+* Exempel:
+*               suggest_labels("debug") => "debug/12-0-crop.jpg YAJ066" för varje läsbart utklipp
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int suggest_labels(const std::string &directory) {
+	tesseract::TessBaseAPI *api = new tesseract::TessBaseAPI();
+	if (api->Init(NULL, TRAIN_FLAGS.language.c_str())) {
+		fprintf(stderr, "Could not initialize tesseract.\n");
+		delete api;
+		return 1;
+	}
+
+	std::vector<std::string> crops;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory)) {
+		std::string stem = entry.path().stem().string();
+		if (stem.size() > 5 && stem.compare(stem.size() - 5, 5, "-crop") == 0)
+			crops.push_back(entry.path().string()); // Any of the --debug-format extensions
+	}
+	std::sort(crops.begin(), crops.end());
+
+	for (std::string &path : crops) {
+		cv::Mat crop = cv::imread(path);
+		if (crop.empty())
+			continue;
+		std::string answer, parsed;
+		run_ocr(api, crop, answer);
+		parse_answer(answer, parsed);
+		if (parsed.empty())
+			printf("# %s\n", path.c_str());
+		else
+			printf("%s %s\n", path.c_str(), parsed.c_str());
+	}
+
+	api->End();
+	delete api;
+	return 0;
+}
+
+/** Beskrivning:  Tränar modellen för PlateClassifier från märkta utklipp. Varje utklipp delas upp med segment_plate() och används bara när antalet
+*									tecken stämmer med etiketten. Var holdout:e utklipp hålls först utanför för att mäta träffsäkerheten, sedan tränas de in också
+* Argument 1:   int - antal argument
+* Argument 2:   char** - etikettfil och modellfil, eller --suggest och en katalog med utklipp. Valfria flaggor: --holdout=N, --confidence=F, --lang=språk
+* Return:       int - status kod för programmet
+* Exempel:
+*               ./anpr_train_ocr --suggest debug > labels.txt
+*               ./anpr_train_ocr labels.txt ocr_model.yml => "Learned 1830 characters from 305 of 320 crops"
+*
+* By:           agent
+* Date:         2026-10-17
+**/
+int main(int argc, char** argv) {
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; i++) {
+		const char *value;
+		if (strcmp(argv[i], "--suggest") == 0) {
+			TRAIN_FLAGS.suggest = true;
+		} else if ((value = flag_value(argv[i], "--lang="))) {
+			TRAIN_FLAGS.language = value;
+		} else if ((value = flag_value(argv[i], "--holdout="))) {
+			TRAIN_FLAGS.holdout = std::max(0, atoi(value));
+		} else if ((value = flag_value(argv[i], "--confidence="))) {
+			TRAIN_FLAGS.min_confidence = atof(value);
+		} else {
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (TRAIN_FLAGS.suggest) {
+		if (inputs.size() != 1) {
+			std::cerr << "Please pass a directory of crops" << std::endl;
+			return 1;
+		}
+		return suggest_labels(inputs[0]);
+	}
+	if (inputs.size() != 2) {
+		std::cerr << "Please pass a labels file and the model file to write" << std::endl;
+		return 1;
+	}
+
+	std::vector<Example> examples;
+	if (!read_labels(inputs[0], examples)) {
+		std::cerr << "Cannot read " << inputs[0] << std::endl;
+		return 1;
+	}
+
+	/* Segment every crop once, crops that do not split into their label's characters cannot be used */
+	std::vector<std::vector<cv::Mat>> segmented;
+	std::vector<std::string> labels;
+	size_t unreadable = 0;
+	for (Example &example : examples) {
+		cv::Mat crop = cv::imread(example.path);
+		if (crop.empty()) {
+			std::cerr << "Cannot read " << example.path << std::endl;
+			unreadable++;
+			continue;
+		}
+		std::vector<cv::Mat> glyphs;
+		if (segment_plate(crop, glyphs) != example.label.size())
+			continue;
+		segmented.push_back(glyphs);
+		labels.push_back(example.label);
+	}
+
+	/* Train without the held out crops and see how they are read */
+	PlateClassifier classifier(TRAIN_FLAGS.min_confidence);
+	std::vector<size_t> held_out;
+	for (size_t i = 0; i < segmented.size(); i++) {
+		if (TRAIN_FLAGS.holdout > 1 && i % TRAIN_FLAGS.holdout == TRAIN_FLAGS.holdout - 1) {
+			held_out.push_back(i);
+			continue;
+		}
+		for (size_t j = 0; j < segmented[i].size(); j++)
+			classifier.add(segmented[i][j], labels[i][j]);
+	}
+	if (!held_out.empty() && classifier.size() > 0) {
+		size_t accepted = 0, correct = 0;
+		for (size_t i : held_out) {
+			std::string read;
+			float lowest = 1.0f;
+			for (const cv::Mat &glyph : segmented[i]) {
+				float confidence;
+				read += classifier.nearest(glyph, confidence);
+				lowest = std::min(lowest, confidence);
+			}
+			if (lowest < TRAIN_FLAGS.min_confidence)
+				continue;
+			accepted++;
+			if (read == labels[i])
+				correct++;
+		}
+		std::cerr << "Held out " << held_out.size() << " crops: " << accepted << " accepted at confidence " << TRAIN_FLAGS.min_confidence
+			<< ", " << correct << " of them correct" << std::endl;
+	}
+	for (size_t i : held_out) {
+		for (size_t j = 0; j < segmented[i].size(); j++)
+			classifier.add(segmented[i][j], labels[i][j]);
+	}
+
+	std::map<char, int> per_character;
+	for (std::string &label : labels)
+		for (char c : label)
+			per_character[c]++;
+	std::cerr << "Learned " << classifier.size() << " characters from " << segmented.size() << " of " << examples.size() << " crops";
+	if (unreadable > 0)
+		std::cerr << " (" << unreadable << " could not be read)";
+	std::cerr << std::endl;
+	for (std::pair<const char, int> &count : per_character)
+		std::cerr << count.first << ":" << count.second << " ";
+	std::cerr << std::endl;
+
+	if (classifier.size() == 0 || !classifier.save(inputs[1])) {
+		std::cerr << "Cannot write " << inputs[1] << std::endl;
+		return 1;
+	}
+	return 0;
+}